@@ -0,0 +1,322 @@
+// BigInteger microbenchmark suite
+//
+// Times construction from a decimal string, toString, add, sub, mul,
+// floorDiv, mod and pow over operand sizes from 1 to 100k limbs and reports
+// min / p10 / median / p90 / max per case.
+//
+// Usage: bigint_bench [options]
+//   --reps N          samples per case (default 15)
+//   --budget SECONDS  stop sampling a case after this long, keeping at least
+//                     3 samples (default 1.0)
+//   --max-limbs N     skip operand sizes above N (default 100000)
+//   --ops LIST        comma-separated subset, e.g. mul,floorDiv
+//   --json PATH       write results as JSON ("-" for stdout)
+//   --baseline PATH   JSON from an earlier run; prints median ratios
+//
+// Operand shapes: binary ops take two random n-limb operands; floorDiv and
+// mod divide a 2n-limb number by an n-limb one; pow raises 3 to the exponent
+// that gives an n-limb result. Each sample times a batch of calls sized so
+// the sample is long enough for the clock, and reports time per call.
+// Division and toString are quadratic at the top end, so the 100k-limb row
+// alone takes a few minutes; --max-limbs 16384 gives a quick run.
+
+#include "BigInteger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct Options {
+    size_t reps = 15;
+    double budgetSeconds = 1.0;
+    size_t maxLimbs = 100000;
+    std::vector<std::string> ops;
+    std::string jsonPath;
+    std::string baselinePath;
+};
+
+struct Result {
+    std::string op;
+    size_t limbs;
+    size_t samples;
+    size_t batch;
+    double minNs, p10Ns, medianNs, p90Ns, maxNs;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps results observable so the optimizer cannot drop the timed calls
+static volatile size_t sink = 0;
+
+static const char* const ALL_OPS[] = {
+    "ctor", "toString", "add", "sub", "mul", "floorDiv", "mod", "pow"
+};
+
+static const size_t SIZES[] = {1, 4, 16, 64, 256, 1024, 4096, 16384, 100000};
+
+// Samples shorter than this are batched so clock overhead stays negligible
+static const double MIN_SAMPLE_NS = 20000.0;
+
+// Decimal digits of a random number at most `limbs` limbs wide (the top
+// limb is partially filled, so it never spills into one more)
+static std::string randomOperand(std::mt19937_64& rng, size_t limbs) {
+    size_t digits = (size_t)(limbs * 64 * 0.30102999566398120);
+    if (digits == 0) {
+        digits = 1;
+    }
+    std::string s(digits, '0');
+    s[0] = '1' + rng() % 9;
+    for (size_t i = 1; i < digits; i++) {
+        s[i] = '0' + rng() % 10;
+    }
+    return s;
+}
+
+template <typename Op>
+static double timeBatch(Op& op, size_t batch) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < batch; i++) {
+        op();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+template <typename Op>
+static Result measure(const std::string& name, size_t limbs, const Options& options, Op op) {
+    // Double the batch until one sample is long enough to time reliably
+    size_t batch = 1;
+    while (batch < (1u << 20) && timeBatch(op, batch) < MIN_SAMPLE_NS) {
+        batch *= 2;
+    }
+
+    std::vector<double> samples;
+    auto start = Clock::now();
+    for (size_t i = 0; i < options.reps; i++) {
+        samples.push_back(timeBatch(op, batch) / batch);
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (samples.size() >= 3 && elapsed > options.budgetSeconds) {
+            break;
+        }
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result r;
+    r.op = name;
+    r.limbs = limbs;
+    r.samples = samples.size();
+    r.batch = batch;
+    r.minNs = samples.front();
+    r.p10Ns = percentile(samples, 0.10);
+    r.medianNs = percentile(samples, 0.50);
+    r.p90Ns = percentile(samples, 0.90);
+    r.maxNs = samples.back();
+    return r;
+}
+
+static bool wanted(const Options& options, const std::string& op) {
+    return options.ops.empty() ||
+           std::find(options.ops.begin(), options.ops.end(), op) != options.ops.end();
+}
+
+static std::string formatJsonLine(const Result& r) {
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"op\": \"%s\", \"limbs\": %zu, \"samples\": %zu, \"batch\": %zu, "
+                  "\"min_ns\": %.1f, \"p10_ns\": %.1f, \"median_ns\": %.1f, \"p90_ns\": %.1f, \"max_ns\": %.1f}",
+                  r.op.c_str(), r.limbs, r.samples, r.batch,
+                  r.minNs, r.p10Ns, r.medianNs, r.p90Ns, r.maxNs);
+    return buf;
+}
+
+// Results are written one object per line, so a saved file can be read
+// back line by line without a JSON parser
+static void writeJson(std::FILE* out, const Options& options, const std::vector<Result>& results) {
+    std::fprintf(out, "{\n  \"benchmark\": \"bigint_bench\",\n  \"reps\": %zu,\n  \"budget_seconds\": %.3f,\n  \"results\": [\n",
+                 options.reps, options.budgetSeconds);
+    for (size_t i = 0; i < results.size(); i++) {
+        std::fprintf(out, "    %s%s\n", formatJsonLine(results[i]).c_str(), i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+// (op, limbs) -> median_ns from a file written by writeJson
+static std::map<std::pair<std::string, size_t>, double> readBaseline(const std::string& path) {
+    std::map<std::pair<std::string, size_t>, double> medians;
+    std::ifstream in(path);
+    if (!in) {
+        std::fprintf(stderr, "bigint_bench: cannot read baseline %s\n", path.c_str());
+        std::exit(1);
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        char op[64];
+        size_t limbs;
+        const char* median = std::strstr(line.c_str(), "\"median_ns\": ");
+        if (median && std::sscanf(line.c_str(), " {\"op\": \"%63[^\"]\", \"limbs\": %zu", op, &limbs) == 2) {
+            medians[{op, limbs}] = std::atof(median + std::strlen("\"median_ns\": "));
+        }
+    }
+    return medians;
+}
+
+static Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "bigint_bench: %s needs a value\n", arg.c_str());
+            std::exit(2);
+        }
+        std::string value = argv[++i];
+        if (arg == "--reps") {
+            options.reps = std::max<size_t>(1, std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--budget") {
+            options.budgetSeconds = std::atof(value.c_str());
+        } else if (arg == "--max-limbs") {
+            options.maxLimbs = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--ops") {
+            size_t start = 0;
+            while (start <= value.size()) {
+                size_t comma = value.find(',', start);
+                if (comma == std::string::npos) {
+                    comma = value.size();
+                }
+                if (comma > start) {
+                    options.ops.push_back(value.substr(start, comma - start));
+                }
+                start = comma + 1;
+            }
+        } else if (arg == "--json") {
+            options.jsonPath = value;
+        } else if (arg == "--baseline") {
+            options.baselinePath = value;
+        } else {
+            std::fprintf(stderr, "bigint_bench: unknown option %s\n", arg.c_str());
+            std::exit(2);
+        }
+    }
+    for (const auto& op : options.ops) {
+        if (std::find(std::begin(ALL_OPS), std::end(ALL_OPS), op) == std::end(ALL_OPS)) {
+            std::fprintf(stderr, "bigint_bench: unknown op %s\n", op.c_str());
+            std::exit(2);
+        }
+    }
+    return options;
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+    std::map<std::pair<std::string, size_t>, double> baseline;
+    if (!options.baselinePath.empty()) {
+        baseline = readBaseline(options.baselinePath);
+    }
+
+    // The human-readable table moves to stderr when JSON goes to stdout
+    std::FILE* table = options.jsonPath == "-" ? stderr : stdout;
+    std::fprintf(table, "%-9s %7s %5s %13s %13s %13s %13s %13s", "op", "limbs", "n", "min_ns", "p10_ns", "median_ns",
+                 "p90_ns", "max_ns");
+    std::fprintf(table, baseline.empty() ? "\n" : " %9s\n", "vs_base");
+
+    std::vector<Result> results;
+    auto report = [&](const Result& r) {
+        std::fprintf(table, "%-9s %7zu %5zu %13.1f %13.1f %13.1f %13.1f %13.1f",
+                     r.op.c_str(), r.limbs, r.samples, r.minNs, r.p10Ns, r.medianNs, r.p90Ns, r.maxNs);
+        auto it = baseline.find({r.op, r.limbs});
+        if (it != baseline.end() && it->second > 0) {
+            std::fprintf(table, " %8.3fx", r.medianNs / it->second);
+        }
+        std::fprintf(table, "\n");
+        std::fflush(table);
+        results.push_back(r);
+    };
+
+    std::mt19937_64 rng(20240601);
+    for (size_t limbs : SIZES) {
+        if (limbs > options.maxLimbs) {
+            break;
+        }
+        std::string aDigits = randomOperand(rng, limbs);
+        BigInteger a(aDigits);
+        BigInteger b(randomOperand(rng, limbs));
+        BigInteger wide(randomOperand(rng, 2 * limbs));
+
+        if (wanted(options, "ctor")) {
+            report(measure("ctor", limbs, options, [&] {
+                BigInteger r(aDigits);
+                sink += r.isZero();
+            }));
+        }
+        if (wanted(options, "toString")) {
+            report(measure("toString", limbs, options, [&] {
+                sink += a.toString().size();
+            }));
+        }
+        if (wanted(options, "add")) {
+            report(measure("add", limbs, options, [&] {
+                BigInteger r = a + b;
+                sink += r.isZero();
+            }));
+        }
+        if (wanted(options, "sub")) {
+            report(measure("sub", limbs, options, [&] {
+                BigInteger r = a - b;
+                sink += r.isZero();
+            }));
+        }
+        if (wanted(options, "mul")) {
+            report(measure("mul", limbs, options, [&] {
+                BigInteger r = a * b;
+                sink += r.isZero();
+            }));
+        }
+        if (wanted(options, "floorDiv")) {
+            report(measure("floorDiv", limbs, options, [&] {
+                BigInteger r = wide.floorDiv(a);
+                sink += r.isZero();
+            }));
+        }
+        if (wanted(options, "mod")) {
+            report(measure("mod", limbs, options, [&] {
+                BigInteger r = wide % a;
+                sink += r.isZero();
+            }));
+        }
+        if (wanted(options, "pow")) {
+            // 3^e has e * log2(3) bits; pick e so the result is `limbs` limbs
+            uint64_t exponent = (uint64_t)((limbs * 64 - 1) / 1.5849625007211562);
+            BigInteger three(3);
+            report(measure("pow", limbs, options, [&] {
+                BigInteger r = three.pow(exponent);
+                sink += r.isZero();
+            }));
+        }
+    }
+
+    if (!options.jsonPath.empty()) {
+        if (options.jsonPath == "-") {
+            writeJson(stdout, options, results);
+        } else {
+            std::FILE* out = std::fopen(options.jsonPath.c_str(), "w");
+            if (!out) {
+                std::fprintf(stderr, "bigint_bench: cannot write %s\n", options.jsonPath.c_str());
+                return 1;
+            }
+            writeJson(out, options, results);
+            std::fclose(out);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Lexer throughput benchmark
+//
+// Runs Python3Lexer (or the hand-written Tokenizer) over a large input and
+// reports tokens and bytes per second. The input is either a file or a generated script that exercises
+// the NEWLINE action: nested blocks, tab and space indentation, blank and
+// comment-only lines, and line breaks inside brackets.
+//
+// Usage: lex_bench [options]
+//   --file PATH     lex this file instead of the generated script
+//   --lines N       lines of generated script (default 100000)
+//   --reps N        timed runs; the fastest is reported (default 3)
+//   --tokenizer     lex with src/Tokenizer instead of Python3Lexer
+//   --dump          print every token (type, line:column, text) once and exit,
+//                   for diffing the token stream of two builds
+
+#include "Python3Lexer.h"
+#include "Tokenizer.h"
+#include "antlr4-runtime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static std::string generateScript(size_t lines) {
+    std::string out;
+    size_t i = 0;
+    while (i < lines) {
+        // One block of 12 lines, two levels deep
+        out += "def f" + std::to_string(i) + "(a, b):\n";
+        out += "    x = a + b * " + std::to_string(i) + "\n";
+        out += "\n";
+        out += "    # comment line\n";
+        out += "    while x < b:\n";
+        out += "\tx += 1\n";
+        out += "        if x % 3 == 0:\n";
+        out += "            print(x, [1, 2,\n";
+        out += "                      3])\n";
+        out += "    \n";
+        out += "    return x\n";
+        out += "print(f" + std::to_string(i) + "(1, 2))\n";
+        i += 12;
+    }
+    return out;
+}
+
+// Lexes the whole input; returns the number of tokens (EOF included)
+static size_t lexAll(const std::string& source, bool tokenizer, bool dump) {
+    antlr4::ANTLRInputStream input(source);
+    std::unique_ptr<antlr4::TokenSource> lexer;
+    if (tokenizer) {
+        lexer = std::make_unique<Tokenizer>(&input);
+    } else {
+        lexer = std::make_unique<Python3Lexer>(&input);
+    }
+    size_t count = 0;
+    for (;;) {
+        std::unique_ptr<antlr4::Token> token = lexer->nextToken();
+        count++;
+        if (dump) {
+            std::string text = token->getText();
+            std::string escaped;
+            for (char c : text) {
+                if (c == '\n') {
+                    escaped += "\\n";
+                } else if (c == '\r') {
+                    escaped += "\\r";
+                } else if (c == '\t') {
+                    escaped += "\\t";
+                } else {
+                    escaped += c;
+                }
+            }
+            std::printf("%zu %zu:%zu %zu-%zu '%s'\n", token->getType(), token->getLine(),
+                        token->getCharPositionInLine(), token->getStartIndex(), token->getStopIndex(),
+                        escaped.c_str());
+        }
+        if (token->getType() == antlr4::Token::EOF) {
+            break;
+        }
+    }
+    return count;
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    size_t lines = 100000;
+    size_t reps = 3;
+    bool dump = false;
+    bool tokenizer = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--dump") {
+            dump = true;
+            continue;
+        }
+        if (arg == "--tokenizer") {
+            tokenizer = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "lex_bench: %s needs a value\n", arg.c_str());
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--file") {
+            path = value;
+        } else if (arg == "--lines") {
+            lines = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--reps") {
+            reps = std::max<size_t>(1, std::strtoul(value.c_str(), nullptr, 10));
+        } else {
+            std::fprintf(stderr, "lex_bench: unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    std::string source;
+    if (!path.empty()) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "lex_bench: cannot read %s\n", path.c_str());
+            return 1;
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        source = buffer.str();
+    } else {
+        source = generateScript(lines);
+    }
+
+    if (dump) {
+        lexAll(source, tokenizer, true);
+        return 0;
+    }
+
+    double best = 0;
+    size_t tokens = 0;
+    for (size_t r = 0; r < reps; r++) {
+        auto start = Clock::now();
+        tokens = lexAll(source, tokenizer, false);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (r == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    std::printf("%zu bytes, %zu tokens: %.3f s, %.2f MB/s, %.0f tokens/s\n", source.size(), tokens, best,
+                source.size() / best / 1e6, tokens / best);
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Microbenchmark for the BigInteger limb kernels (add, subtract, compare)
+//
+// Usage: limb_bench [min_seconds_per_case]
+// Operands are random decimal numbers of 10^3 .. 10^6 digits. Each case is
+// repeated until it has run for at least min_seconds (default 0.2); the mean
+// time per operation and per limb is printed.
+
+#include "BigInteger.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+static std::string randomDigits(std::mt19937_64& rng, size_t digits) {
+    std::string s(digits, '0');
+    s[0] = '1' + rng() % 9;
+    for (size_t i = 1; i < digits; i++) {
+        s[i] = '0' + rng() % 10;
+    }
+    return s;
+}
+
+// Runs op until minSeconds have elapsed; returns mean nanoseconds per call
+template <typename Op>
+static double timeOp(double minSeconds, Op op) {
+    using Clock = std::chrono::steady_clock;
+    size_t iterations = 0;
+    auto start = Clock::now();
+    double elapsed = 0;
+    do {
+        op();
+        iterations++;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return elapsed * 1e9 / iterations;
+}
+
+int main(int argc, char** argv) {
+    double minSeconds = argc > 1 ? std::atof(argv[1]) : 0.2;
+    std::mt19937_64 rng(12345);
+    volatile long long sink = 0;
+
+    std::printf("%-8s %10s %8s %14s %10s\n", "op", "digits", "limbs", "ns/op", "ns/limb");
+    for (size_t digits = 1000; digits <= 1000000; digits *= 10) {
+        BigInteger a(randomDigits(rng, digits));
+        BigInteger b(randomDigits(rng, digits));
+        if (a < b) {
+            std::swap(a, b);
+        }
+        // Same value plus one: compare has to scan down to the lowest limb
+        BigInteger nearA = a + BigInteger(1);
+        double limbs = (double)((a.bitLength() + 63) / 64);
+
+        double add = timeOp(minSeconds, [&] {
+            BigInteger r = a + b;
+            sink += r.isZero();
+        });
+        double sub = timeOp(minSeconds, [&] {
+            BigInteger r = a - b;
+            sink += r.isZero();
+        });
+        double addAssign = timeOp(minSeconds, [&] {
+            a += b;
+            a -= b;
+        });
+        double cmp = timeOp(minSeconds, [&] {
+            sink += (a < nearA);
+        });
+
+        std::printf("%-8s %10zu %8.0f %14.1f %10.3f\n", "add", digits, limbs, add, add / limbs);
+        std::printf("%-8s %10zu %8.0f %14.1f %10.3f\n", "sub", digits, limbs, sub, sub / limbs);
+        std::printf("%-8s %10zu %8.0f %14.1f %10.3f\n", "+=/-=", digits, limbs, addAssign, addAssign / (2 * limbs));
+        std::printf("%-8s %10zu %8.0f %14.1f %10.3f\n", "compare", digits, limbs, cmp, cmp / limbs);
+    }
+    return (int)(sink & 0);
+}
@@ -1,6 +1,5 @@
 
 #include <list>
-#include <regex>
 
 
 // Generated from resources/Python3Lexer.g4 by ANTLR 4.13.2
@@ -562,10 +561,8 @@ void Python3Lexer::NEWLINEAction(antlr4::RuleContext *context, size_t actionInde
   switch (actionIndex) {
     case 0: 
     { // Braces are required inside the switch
-    	std::regex re1(R"([^\r\n\f]+)");
-    	std::regex re2(R"([\r\n\f]+)");
-    	std::string newLine = regex_replace(getText(), re1, "");
-    	std::string spaces = regex_replace(getText(), re2, "");
+    	std::string newLine, spaces;
+    	splitNewline(getText(), newLine, spaces);
     	int next = _input->LA(1);
     	if (opened > 0 || next == '\r' || next == '\n' || next == '\f' || next == '#') {
     		// If we're inside a list or on a blank line, ignore all indents,
@@ -6,7 +6,6 @@ tokens {
 
 @header {
 #include <list>
-#include <regex>
 }
 
 @lexer::members {
@@ -30,6 +29,11 @@ public:
 
 public:
 	std::unique_ptr<antlr4::Token> nextToken() override {
+		// The ATN and the DFA cache are shared by all lexer instances; the first
+		// call extends both
+		static const size_t codeMode = installResolvedMode(*this, false);
+		static const size_t formatTextMode = installResolvedMode(*this, true);
+
 		// Check if the end-of-file is ahead and there are still some DEDENTS expected.
 		if (_input->LA(1) == EOF && !this->indents.empty()) {
 			// Remove any trailing EOF tokens from our buffer.
@@ -53,8 +57,12 @@ public:
 
 			// Put the EOF back on the token stream.
 			this->emit(make_CommonToken(static_cast<int>(Python3Lexer::EOF), "<EOF>"));
+			// emit() leaves the last token in `token` too; these are owned by the queue
+			token.release();
 		}
 		if (tokens.empty()) {
+			if (atStartOfInput()) setMode(DEFAULT_MODE);
+			else setMode(format_mode > 0 && !expr_mode ? formatTextMode : codeMode);
 			std::unique_ptr<antlr4::Token> next = Lexer::nextToken();
 			next.release();
 			// release it because it should be controlled by 'tokens' now
@@ -93,9 +101,145 @@ private:
 			else ++count; // normal space char
 		return count;
 	}
+
+	// Splits the text of a NEWLINE token into its line break characters
+	// ('\r', '\n', '\f') and everything else (the indentation), in one pass.
+	static void splitNewline(std::string const &text, std::string &newLine, std::string &spaces) {
+		for (auto ch : text)
+			if (ch == '\r' || ch == '\n' || ch == '\f') newLine += ch;
+			else spaces += ch;
+	}
 	bool atStartOfInput() {
 		return Lexer::getCharPositionInLine() == 0 && Lexer::getLine() == 1;
 	}
+
+	// Past the first token every predicate in this grammar is decided by which
+	// part of the input is being lexed: in ordinary code (and inside the {}
+	// of an f-string) {format_mode == 0 || expr_mode}? holds and the predicates
+	// of FORMAT_STRING_LITERAL and QUOTATION fail; in the text part of an
+	// f-string it is the other way round; NEWLINE's atStartOfInput() always
+	// fails. For each of the two cases this adds a lexer mode whose ATN is a
+	// copy of DEFAULT_MODE with the predicates resolved: true ones become plain
+	// epsilon edges, false ones are dropped. Without predicates
+	// LexerATNSimulator caches the mode's DFA instead of re-running the ATN from
+	// the start state for every token. DEFAULT_MODE keeps its predicates and
+	// lexes the first token. Returns the new mode's index. Must run before the
+	// first match, as it grows the DFA cache; nextToken calls it once per case
+	// for the shared ATN.
+	static size_t installResolvedMode(Python3Lexer &lexer, bool formatText) {
+		using namespace antlr4::atn;
+		ATN &atn = const_cast<ATN &>(lexer.getATN());
+		std::vector<antlr4::dfa::DFA> &dfas = lexer.getInterpreter<LexerATNSimulator>()->_decisionToDFA;
+		std::unordered_map<ATNState *, ATNState *> copies;
+		std::vector<ATNState *> pending;
+		// Rule stop states are shared: leaving a rule only consults the context
+		auto copyOf = [&](ATNState *state) -> ATNState * {
+			if (state->getStateType() == ATNStateType::RULE_STOP) return state;
+			auto found = copies.find(state);
+			if (found != copies.end()) return found->second;
+			ATNState *copy = nullptr;
+			switch (state->getStateType()) {
+				case ATNStateType::BASIC: copy = new BasicState(); break;
+				case ATNStateType::RULE_START: copy = new RuleStartState(); break;
+				case ATNStateType::BLOCK_START: copy = new BasicBlockStartState(); break;
+				case ATNStateType::PLUS_BLOCK_START: copy = new PlusBlockStartState(); break;
+				case ATNStateType::STAR_BLOCK_START: copy = new StarBlockStartState(); break;
+				case ATNStateType::BLOCK_END: copy = new BlockEndState(); break;
+				case ATNStateType::STAR_LOOP_BACK: copy = new StarLoopbackState(); break;
+				case ATNStateType::STAR_LOOP_ENTRY: copy = new StarLoopEntryState(); break;
+				case ATNStateType::PLUS_LOOP_BACK: copy = new PlusLoopbackState(); break;
+				case ATNStateType::LOOP_END: copy = new LoopEndState(); break;
+				default: throw antlr4::IllegalStateException("unexpected ATN state in lexer rule");
+			}
+			copy->ruleIndex = state->ruleIndex;
+			if (DecisionState::is(state)) {
+				static_cast<DecisionState *>(copy)->nonGreedy = static_cast<DecisionState *>(state)->nonGreedy;
+			}
+			atn.addState(copy);
+			copies.emplace(state, copy);
+			pending.push_back(state);
+			return copy;
+		};
+		auto predicateHolds = [&](size_t ruleIndex) {
+			size_t type = atn.ruleToTokenType[ruleIndex];
+			if (type == NEWLINE) return false;
+			return (type == FORMAT_STRING_LITERAL || type == QUOTATION) == formatText;
+		};
+
+		TokensStartState *start = new TokensStartState();
+		atn.addState(start);
+		for (const auto &t : atn.modeToStartState[DEFAULT_MODE]->transitions) {
+			start->addTransition(std::make_unique<EpsilonTransition>(copyOf(t->target)));
+		}
+		while (!pending.empty()) {
+			ATNState *state = pending.back();
+			pending.pop_back();
+			ATNState *copy = copies[state];
+			for (const auto &t : state->transitions) {
+				switch (t->getTransitionType()) {
+					case TransitionType::PREDICATE:
+						if (predicateHolds(static_cast<const PredicateTransition *>(t.get())->getRuleIndex())) {
+							copy->addTransition(std::make_unique<EpsilonTransition>(copyOf(t->target)));
+						}
+						break;
+					case TransitionType::EPSILON:
+						copy->addTransition(std::make_unique<EpsilonTransition>(copyOf(t->target),
+							static_cast<const EpsilonTransition *>(t.get())->outermostPrecedenceReturn()));
+						break;
+					case TransitionType::RULE: {
+						auto rule = static_cast<const RuleTransition *>(t.get());
+						copy->addTransition(std::make_unique<RuleTransition>(static_cast<RuleStartState *>(copyOf(rule->target)),
+							rule->ruleIndex, rule->precedence, copyOf(rule->followState)));
+						break;
+					}
+					case TransitionType::RANGE: {
+						auto range = static_cast<const RangeTransition *>(t.get());
+						copy->addTransition(std::make_unique<RangeTransition>(copyOf(t->target), range->from, range->to));
+						break;
+					}
+					case TransitionType::ATOM:
+						copy->addTransition(std::make_unique<AtomTransition>(copyOf(t->target),
+							static_cast<const AtomTransition *>(t.get())->_label));
+						break;
+					case TransitionType::ACTION: {
+						auto action = static_cast<const ActionTransition *>(t.get());
+						copy->addTransition(std::make_unique<ActionTransition>(copyOf(t->target), action->ruleIndex,
+							action->actionIndex, action->isCtxDependent));
+						break;
+					}
+					case TransitionType::SET:
+						copy->addTransition(std::make_unique<SetTransition>(copyOf(t->target),
+							static_cast<const SetTransition *>(t.get())->set));
+						break;
+					case TransitionType::NOT_SET:
+						copy->addTransition(std::make_unique<NotSetTransition>(copyOf(t->target),
+							static_cast<const NotSetTransition *>(t.get())->set));
+						break;
+					case TransitionType::WILDCARD:
+						copy->addTransition(std::make_unique<WildcardTransition>(copyOf(t->target)));
+						break;
+					default:
+						throw antlr4::IllegalStateException("unexpected ATN transition in lexer rule");
+				}
+			}
+		}
+		// LexerATNSimulator caches the DFA of mode m in _decisionToDFA[m], but
+		// the generated code sizes that vector by decision, and past DEFAULT_MODE
+		// the decisions are blocks inside the rules. So the new start state
+		// becomes the next decision, with a DFA of its own, and its mode index is
+		// that decision's number; the modes in between are never entered and only
+		// fill modeToStartState up to it
+		size_t mode = atn.defineDecisionState(start);
+		if (mode != dfas.size()) {
+			throw antlr4::IllegalStateException("lexer DFA cache does not match the ATN's decisions");
+		}
+		dfas.emplace_back(start, mode);
+		while (atn.modeToStartState.size() < mode) {
+			atn.modeToStartState.push_back(atn.modeToStartState[DEFAULT_MODE]);
+		}
+		atn.modeToStartState.push_back(start);
+		return mode;
+	}
 }
 
 STRING: STRING_LITERAL | BYTES_LITERAL;
@@ -131,10 +275,8 @@ NEWLINE: (
 		| ( '\r'? '\n' | '\r' | '\f') SPACES?
 	) {
 { // Braces are required inside the switch
-	std::regex re1(R"([^\r\n\f]+)");
-	std::regex re2(R"([\r\n\f]+)");
-	std::string newLine = regex_replace(getText(), re1, "");
-	std::string spaces = regex_replace(getText(), re2, "");
+	std::string newLine, spaces;
+	splitNewline(getText(), newLine, spaces);
 	int next = _input->LA(1);
 	if (opened > 0 || next == '\r' || next == '\n' || next == '\f' || next == '#') {
 		// If we're inside a list or on a blank line, ignore all indents,
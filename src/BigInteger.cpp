@@ -1,538 +1,2101 @@
 #include "BigInteger.h"
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
 #include <stdexcept>
+#include <system_error>
+#include <thread>
 #include <sstream>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <vector>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
 
-// Constructors
+// Limb kernels
+//
+// All multi-limb arithmetic funnels through these raw-pointer routines.
+// Operands are little-endian limb arrays; the caller owns sizing.
 
-BigInteger::BigInteger() : digits(), negative(false) {
-    // Default: represents zero (empty vector)
+typedef uint64_t Limb;
+typedef unsigned __int128 DoubleLimb;
+
+// Below this many limbs schoolbook multiplication beats Karatsuba
+static const size_t KARATSUBA_THRESHOLD = 32;
+
+// Decimal strings up to this many digits are parsed/printed limb by limb;
+// longer ones are split around a power of 10 (divide-and-conquer)
+static const size_t DECIMAL_BASECASE_DIGITS = 19 * 40;
+
+// Barrett reduction forms only the needed columns of its two quotient
+// products below this size; above it full Karatsuba products are cheaper
+static const size_t BARRETT_TRUNCATED_MAX_LIMBS = 4 * KARATSUBA_THRESHOLD;
+
+// Below this many limbs the scalar compare loop beats the AVX2 one
+static const size_t SIMD_COMPARE_MIN_LIMBS = 16;
+
+// Karatsuba products at least this wide run their sub-products in parallel;
+// below it a sub-product takes well under a millisecond and a thread start
+// would eat the gain
+static const size_t PARALLEL_MUL_THRESHOLD = 2048;
+
+// toString splits of values at least this wide render the two halves in parallel
+static const size_t PARALLEL_DECIMAL_THRESHOLD = 4096;
+
+// BigInteger::sum adds every operand into an output block of this many limbs
+// (4 KiB, so it stays in L1) before moving on to the next block
+static const size_t SUM_BLOCK_LIMBS = 512;
+
+// Fork-join helpers
+//
+// Work is forked only onto a fresh helper thread while the global budget
+// allows, otherwise it runs inline, so nesting can never deadlock and a
+// forked task is always a pure function of its inputs writing disjoint
+// output: parallel and serial runs produce the same limbs.
+
+static unsigned defaultHelperLimit() {
+    unsigned threads = 0;
+    if (const char* env = std::getenv("BIGINT_THREADS")) {
+        threads = (unsigned)std::strtoul(env, nullptr, 10);
+    } else {
+        threads = std::min(std::thread::hardware_concurrency(), 8u);
+    }
+    return threads > 1 ? threads - 1 : 0;
 }
 
-BigInteger::BigInteger(long long value) : negative(value < 0) {
-    if (value == 0) {
-        // Zero: empty vector
+static std::atomic<unsigned> helperLimit{defaultHelperLimit()};  // Threads besides the caller
+static std::atomic<unsigned> activeHelpers{0};
+
+// Runs `first` on a helper thread if one is available, `second` on the
+// calling thread, and returns once both are done
+template <typename First, typename Second>
+static void forkJoin(First&& first, Second&& second) {
+    unsigned active = activeHelpers.load(std::memory_order_relaxed);
+    do {
+        if (active >= helperLimit.load(std::memory_order_relaxed)) {
+            first();
+            second();
+            return;
+        }
+    } while (!activeHelpers.compare_exchange_weak(active, active + 1));
+
+    std::thread helper;
+    std::exception_ptr helperError;
+    try {
+        helper = std::thread([&first, &helperError] {
+            try {
+                first();
+            } catch (...) {
+                helperError = std::current_exception();
+            }
+        });
+    } catch (const std::system_error&) {
+        // No threads available (e.g. a sandbox limit): stay serial
+        activeHelpers--;
+        first();
+        second();
         return;
     }
-    
-    // Work with absolute value
-    unsigned long long absValue = (value < 0) ? -(unsigned long long)value : value;
-    
-    while (absValue > 0) {
-        digits.push_back(absValue % BASE);
-        absValue /= BASE;
+    try {
+        second();
+    } catch (...) {
+        helper.join();
+        activeHelpers--;
+        throw;
+    }
+    helper.join();
+    activeHelpers--;
+    if (helperError) {
+        std::rethrow_exception(helperError);
     }
 }
 
-BigInteger::BigInteger(const std::string& str) : negative(false) {
-    if (str.empty() || !isValidNumber(str)) {
-        throw std::invalid_argument("Invalid number string: " + str);
+static inline unsigned char addCarry(unsigned char carry, Limb a, Limb b, Limb& out) {
+#if defined(__x86_64__)
+    unsigned long long result;
+    carry = _addcarry_u64(carry, a, b, &result);
+    out = result;
+    return carry;
+#else
+    Limb sum = a + b;
+    unsigned char c1 = sum < a;
+    out = sum + carry;
+    return c1 | (out < sum);
+#endif
+}
+
+static inline unsigned char subBorrow(unsigned char borrow, Limb a, Limb b, Limb& out) {
+#if defined(__x86_64__)
+    unsigned long long result;
+    borrow = _subborrow_u64(borrow, a, b, &result);
+    out = result;
+    return borrow;
+#else
+    Limb diff = a - b;
+    unsigned char b1 = a < b;
+    out = diff - borrow;
+    return b1 | (diff < (Limb)borrow);
+#endif
+}
+
+// r[0..n) = a[0..n) + b[0..n); returns carry out (r may alias a or b)
+// Unrolled by four so the adc chain only round-trips the carry flag through
+// a register once per four limbs instead of at every loop test
+static Limb addN(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    unsigned char carry = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        carry = addCarry(carry, a[i], b[i], r[i]);
+        carry = addCarry(carry, a[i + 1], b[i + 1], r[i + 1]);
+        carry = addCarry(carry, a[i + 2], b[i + 2], r[i + 2]);
+        carry = addCarry(carry, a[i + 3], b[i + 3], r[i + 3]);
     }
-    
-    // Parse sign
-    size_t startPos = 0;
-    if (str[0] == '-') {
-        negative = true;
-        startPos = 1;
-    } else if (str[0] == '+') {
-        startPos = 1;
+    for (; i < n; i++) {
+        carry = addCarry(carry, a[i], b[i], r[i]);
     }
-    
-    // Remove leading zeros
-    while (startPos < str.length() && str[startPos] == '0') {
-        startPos++;
+    return carry;
+}
+
+// r[0..n) = a[0..n) - b[0..n); returns borrow out (r may alias a or b)
+static Limb subN(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    unsigned char borrow = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        borrow = subBorrow(borrow, a[i], b[i], r[i]);
+        borrow = subBorrow(borrow, a[i + 1], b[i + 1], r[i + 1]);
+        borrow = subBorrow(borrow, a[i + 2], b[i + 2], r[i + 2]);
+        borrow = subBorrow(borrow, a[i + 3], b[i + 3], r[i + 3]);
     }
-    
-    // Check if it's zero
-    if (startPos >= str.length()) {
-        negative = false;
-        return;
+    for (; i < n; i++) {
+        borrow = subBorrow(borrow, a[i], b[i], r[i]);
     }
-    
-    // Parse digits from right to left in groups of 9
-    std::string absStr = str.substr(startPos);
-    int len = absStr.length();
-    
-    for (int i = len; i > 0; i -= BASE_DIGITS) {
-        int start = std::max(0, i - BASE_DIGITS);
-        int count = i - start;
-        std::string digitStr = absStr.substr(start, count);
-        digits.push_back(std::stoi(digitStr));
-    }
-    
-    normalize();
+    return borrow;
 }
 
-BigInteger::BigInteger(const BigInteger& other) 
-    : digits(other.digits), negative(other.negative) {
+// r[0..rn) += a[0..an) with rn >= an; returns carry out of r[rn-1]
+static Limb addInto(Limb* r, size_t rn, const Limb* a, size_t an) {
+    Limb carry = addN(r, r, a, an);
+    for (size_t i = an; carry && i < rn; i++) {
+        carry = (++r[i] == 0);
+    }
+    return carry;
 }
 
-BigInteger& BigInteger::operator=(const BigInteger& other) {
-    if (this != &other) {
-        digits = other.digits;
-        negative = other.negative;
+// r[0..rn) -= a[0..an) with rn >= an; returns borrow out of r[rn-1]
+static Limb subFrom(Limb* r, size_t rn, const Limb* a, size_t an) {
+    Limb borrow = subN(r, r, a, an);
+    for (size_t i = an; borrow && i < rn; i++) {
+        borrow = (r[i]-- == 0);
     }
-    return *this;
+    return borrow;
 }
 
-// Helper methods
-
-void BigInteger::removeLeadingZeros() {
-    while (!digits.empty() && digits.back() == 0) {
-        digits.pop_back();
+// r[0..n) = a[0..n) * b; returns the high limb
+static Limb mul1(Limb* r, const Limb* a, size_t n, Limb b) {
+    Limb carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        DoubleLimb t = (DoubleLimb)a[i] * b + carry;
+        r[i] = (Limb)t;
+        carry = (Limb)(t >> 64);
     }
+    return carry;
 }
 
-void BigInteger::normalize() {
-    removeLeadingZeros();
-    if (digits.empty()) {
-        negative = false; // Zero is always positive
+// r[0..n) += a[0..n) * b; returns the carry limb
+static Limb addMul1(Limb* r, const Limb* a, size_t n, Limb b) {
+    Limb carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        // (2^64-1)^2 + 2 * (2^64-1) == 2^128 - 1: cannot overflow
+        DoubleLimb t = (DoubleLimb)a[i] * b + r[i] + carry;
+        r[i] = (Limb)t;
+        carry = (Limb)(t >> 64);
     }
+    return carry;
 }
 
-bool BigInteger::isZero() const {
-    return digits.empty();
+// r[0..n) -= a[0..n) * b; returns the borrow limb
+static Limb subMul1(Limb* r, const Limb* a, size_t n, Limb b) {
+    Limb borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        DoubleLimb t = (DoubleLimb)a[i] * b + borrow;
+        Limb low = (Limb)t;
+        borrow = (Limb)(t >> 64) + (r[i] < low);
+        r[i] -= low;
+    }
+    return borrow;
 }
 
-bool BigInteger::isNegative() const {
-    return negative && !isZero();
+// Divide the two-limb value (hi, lo) by d (requires hi < d); returns the quotient
+static inline Limb divWide(Limb hi, Limb lo, Limb d, Limb& rem) {
+#if defined(__x86_64__)
+    Limb q;
+    __asm__("divq %4" : "=a"(q), "=d"(rem) : "a"(lo), "d"(hi), "rm"(d));
+    return q;
+#else
+    DoubleLimb n = ((DoubleLimb)hi << 64) | lo;
+    rem = (Limb)(n % d);
+    return (Limb)(n / d);
+#endif
 }
 
-bool BigInteger::fitsInInt() const {
-    // Check if the value fits in a 32-bit signed integer [-2147483648, 2147483647]
-    if (isZero()) return true;
-    
-    // More than 1 digit in base 10^9 means > 999,999,999 which is fine for int,
-    // but 2 digits means >= 1,000,000,000 which might not fit
-    if (digits.size() > 2) return false;
-    if (digits.size() == 1) return true;  // max 999,999,999 < INT_MAX
-    
-    // digits.size() == 2: value = digits[1] * 10^9 + digits[0]
-    // INT_MAX = 2,147,483,647 = 2 * 10^9 + 147,483,647
-    // INT_MIN = -2,147,483,648
-    if (digits[1] > 2) return false;
-    if (digits[1] < 2) return true;
-    // digits[1] == 2
-    if (negative) {
-        // -2,147,483,648 is the limit
-        return digits[0] <= 147483648;
-    } else {
-        // 2,147,483,647 is the limit
-        return digits[0] <= 147483647;
+// Division by an invariant limb (Moller & Granlund, "Improved division by
+// invariant integers", 2011): with d normalized (top bit set) and the
+// reciprocal v = floor((B^2 - 1) / d) - B, each two-by-one step costs two
+// multiplications and a couple of adjustments instead of a hardware divide
+struct LimbDivisor {
+    Limb d;         // Divisor shifted left until its top bit is set
+    Limb v;         // Reciprocal of d
+    int shift;      // Normalization shift
+
+    explicit LimbDivisor(Limb divisor) {
+        shift = __builtin_clzll(divisor);
+        d = divisor << shift;
+        Limb unused;
+        v = divWide(~d, ~Limb(0), d, unused);
     }
-}
 
-int BigInteger::compareAbs(const BigInteger& other) const {
-    if (digits.size() != other.digits.size()) {
-        return digits.size() < other.digits.size() ? -1 : 1;
+    // (hi, lo) / d with hi < d; returns the quotient
+    Limb divide(Limb hi, Limb lo, Limb& rem) const {
+        DoubleLimb q = (DoubleLimb)v * hi + (((DoubleLimb)(hi + 1) << 64) | lo);
+        Limb qh = (Limb)(q >> 64);
+        Limb r = lo - qh * d;
+        if (r > (Limb)q) {
+            qh--;
+            r += d;
+        }
+        if (r >= d) {
+            qh++;
+            r -= d;
+        }
+        rem = r;
+        return qh;
+    }
+};
+
+// Below this many limbs a plain divide per limb beats computing the reciprocal
+static const size_t PREINV_DIVISION_THRESHOLD = 3;
+
+// q[0..n) = a[0..n) / d; returns the remainder (q may alias a)
+static Limb divMod1(Limb* q, const Limb* a, size_t n, Limb d) {
+    Limb rem = 0;
+    if (n < PREINV_DIVISION_THRESHOLD) {
+        for (size_t i = n; i-- > 0; ) {
+            q[i] = divWide(rem, a[i], d, rem);
+        }
+        return rem;
     }
-    
-    for (int i = digits.size() - 1; i >= 0; i--) {
-        if (digits[i] != other.digits[i]) {
-            return digits[i] < other.digits[i] ? -1 : 1;
+
+    // Divide a * 2^shift by d * 2^shift, streaming the shifted dividend limb
+    // by limb: same quotient, remainder scaled by 2^shift
+    LimbDivisor divisor(d);
+    int shift = divisor.shift;
+    if (shift == 0) {
+        for (size_t i = n; i-- > 0; ) {
+            q[i] = divisor.divide(rem, a[i], rem);
         }
+        return rem;
     }
-    
-    return 0; // Equal
+    rem = a[n - 1] >> (64 - shift);
+    for (size_t i = n - 1; i > 0; i--) {
+        Limb lo = (a[i] << shift) | (a[i - 1] >> (64 - shift));
+        q[i] = divisor.divide(rem, lo, rem);
+    }
+    q[0] = divisor.divide(rem, a[0] << shift, rem);
+    return rem >> shift;
 }
 
-std::string BigInteger::toString() const {
-    if (isZero()) {
-        return "0";
+// a[0..n) % d without storing the quotient
+static Limb mod1(const Limb* a, size_t n, Limb d) {
+    Limb rem = 0;
+    if (n < PREINV_DIVISION_THRESHOLD) {
+        for (size_t i = n; i-- > 0; ) {
+            divWide(rem, a[i], d, rem);
+        }
+        return rem;
     }
-    
-    std::string result;
-    if (negative) {
-        result = "-";
+    LimbDivisor divisor(d);
+    int shift = divisor.shift;
+    if (shift == 0) {
+        for (size_t i = n; i-- > 0; ) {
+            divisor.divide(rem, a[i], rem);
+        }
+        return rem;
     }
-    
-    // Most significant digit (no leading zeros)
-    result += std::to_string(digits.back());
-    
-    // Remaining digits (pad to 9 digits)
-    for (int i = digits.size() - 2; i >= 0; i--) {
-        std::string digitStr = std::to_string(digits[i]);
-        result += std::string(BASE_DIGITS - digitStr.length(), '0') + digitStr;
+    rem = a[n - 1] >> (64 - shift);
+    for (size_t i = n - 1; i > 0; i--) {
+        divisor.divide(rem, (a[i] << shift) | (a[i - 1] >> (64 - shift)), rem);
     }
-    
-    return result;
+    divisor.divide(rem, a[0] << shift, rem);
+    return rem >> shift;
 }
 
-long long BigInteger::toLongLong() const {
-    if (isZero()) {
-        return 0;
+// r[0..an+bn) = a[0..an) * b[0..bn); an, bn >= 1; r must not alias a or b
+static void mulBasecase(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    r[an] = mul1(r, a, an, b[0]);
+    for (size_t j = 1; j < bn; j++) {
+        r[an + j] = addMul1(r + j, a, an, b[j]);
+    }
+}
+
+// r[0..2n) = a[0..n) * b[0..n) using Karatsuba:
+//   a = a1*B^h + a0, b = b1*B^h + b0
+//   a*b = z2*B^2h + ((a0+a1)(b0+b1) - z0 - z2)*B^h + z0
+static void mulKaratsuba(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    if (n < KARATSUBA_THRESHOLD) {
+        mulBasecase(r, a, n, b, n);
+        return;
     }
-    
-    long long result = 0;
-    long long multiplier = 1;
-    
-    for (size_t i = 0; i < digits.size(); i++) {
-        result += digits[i] * multiplier;
-        multiplier *= BASE;
+    size_t h = n / 2;       // Size of the low halves
+    size_t hh = n - h;      // Size of the high halves (hh >= h)
+
+    // Middle term operands: (a0 + a1) and (b0 + b1), each hh + 1 limbs
+    std::vector<Limb> tmp(4 * (hh + 1));
+    Limb* sa = tmp.data();
+    Limb* sb = sa + (hh + 1);
+    Limb* mid = sb + (hh + 1);
+    std::copy(a + h, a + n, sa);
+    sa[hh] = addInto(sa, hh, a, h);
+    std::copy(b + h, b + n, sb);
+    sb[hh] = addInto(sb, hh, b, h);
+
+    // z0 -> r[0..2h), z2 -> r[2h..2n), middle -> mid: three independent products
+    auto low = [=] { mulKaratsuba(r, a, b, h); };
+    auto high = [=] { mulKaratsuba(r + 2 * h, a + h, b + h, hh); };
+    auto middle = [=] { mulKaratsuba(mid, sa, sb, hh + 1); };
+    if (n >= PARALLEL_MUL_THRESHOLD) {
+        forkJoin(low, [&] { forkJoin(high, middle); });
+    } else {
+        low();
+        high();
+        middle();
     }
-    
-    return negative ? -result : result;
+
+    size_t midLen = 2 * (hh + 1);
+    subFrom(mid, midLen, r, 2 * h);
+    subFrom(mid, midLen, r + 2 * h, 2 * hh);
+
+    // The middle term is < 2^64 * B^(n), so limbs beyond the end of r are zero
+    size_t room = 2 * n - h;
+    addInto(r + h, room, mid, std::min(midLen, room));
 }
 
-bool BigInteger::isValidNumber(const std::string& str) {
-    if (str.empty()) {
-        return false;
+// r[0..2n) = a[0..n)^2: each cross product a[i]*a[j] (i < j) is formed once,
+// doubled with a shift, then the diagonal squares are added
+static void sqrBasecase(Limb* r, const Limb* a, size_t n) {
+    std::fill(r, r + 2 * n, 0);
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[i + n] = addMul1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
     }
-    
-    size_t start = 0;
-    if (str[0] == '-' || str[0] == '+') {
-        start = 1;
-        if (str.length() == 1) {
-            return false; // Just a sign
-        }
+    // Double the cross products (their sum is < B^2n / 2, nothing shifts out)
+    for (size_t i = 2 * n - 1; i > 0; i--) {
+        r[i] = (r[i] << 1) | (r[i - 1] >> 63);
     }
-    
-    for (size_t i = start; i < str.length(); i++) {
-        if (!isdigit(str[i])) {
-            return false;
-        }
+    r[0] <<= 1;
+    unsigned char carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        DoubleLimb square = (DoubleLimb)a[i] * a[i];
+        carry = addCarry(carry, r[2 * i], (Limb)square, r[2 * i]);
+        carry = addCarry(carry, r[2 * i + 1], (Limb)(square >> 64), r[2 * i + 1]);
     }
-    
-    return true;
 }
 
-// Arithmetic helper methods
+// r[0..2n) = a[0..n)^2 using Karatsuba squaring (three half-size squares)
+static void sqrKaratsuba(Limb* r, const Limb* a, size_t n) {
+    if (n < KARATSUBA_THRESHOLD) {
+        sqrBasecase(r, a, n);
+        return;
+    }
+    size_t h = n / 2;
+    size_t hh = n - h;
 
-BigInteger BigInteger::addAbs(const BigInteger& other) const {
-    BigInteger result;
-    int carry = 0;
-    size_t maxSize = std::max(digits.size(), other.digits.size());
-    
-    for (size_t i = 0; i < maxSize || carry; i++) {
-        long long sum = carry;
-        if (i < digits.size()) {
-            sum += digits[i];
-        }
-        if (i < other.digits.size()) {
-            sum += other.digits[i];
-        }
-        
-        result.digits.push_back(sum % BASE);
-        carry = sum / BASE;
-    }
-    
-    result.normalize();
-    return result;
-}
+    // Middle term: (a0 + a1)^2 - a0^2 - a1^2
+    std::vector<Limb> tmp(3 * (hh + 1));
+    Limb* sa = tmp.data();
+    Limb* mid = sa + (hh + 1);
+    std::copy(a + h, a + n, sa);
+    sa[hh] = addInto(sa, hh, a, h);
 
-BigInteger BigInteger::subtractAbs(const BigInteger& other) const {
-    // Assumes this >= other (in absolute value)
-    BigInteger result;
-    int borrow = 0;
-    
-    for (size_t i = 0; i < digits.size(); i++) {
-        long long diff = digits[i] - borrow;
-        if (i < other.digits.size()) {
-            diff -= other.digits[i];
-        }
-        
-        if (diff < 0) {
-            diff += BASE;
-            borrow = 1;
-        } else {
-            borrow = 0;
-        }
-        
-        result.digits.push_back(diff);
+    auto low = [=] { sqrKaratsuba(r, a, h); };
+    auto high = [=] { sqrKaratsuba(r + 2 * h, a + h, hh); };
+    auto middle = [=] { sqrKaratsuba(mid, sa, hh + 1); };
+    if (n >= PARALLEL_MUL_THRESHOLD) {
+        forkJoin(low, [&] { forkJoin(high, middle); });
+    } else {
+        low();
+        high();
+        middle();
     }
-    
-    result.normalize();
-    return result;
-}
 
-BigInteger BigInteger::multiplyAbs(const BigInteger& other) const {
-    BigInteger result;
-    result.digits.resize(digits.size() + other.digits.size(), 0);
-    
-    // Accumulate products directly into result.digits, propagating carries
-    // immediately to prevent overflow in the accumulator
-    for (size_t i = 0; i < digits.size(); i++) {
-        unsigned long long carry = 0;
-        for (size_t j = 0; j < other.digits.size(); j++) {
-            unsigned long long product = (unsigned long long)digits[i] * other.digits[j];
-            unsigned long long sum = result.digits[i + j] + product + carry;
-            result.digits[i + j] = sum % BASE;
-            carry = sum / BASE;
-        }
-        // Propagate any remaining carry
-        size_t k = i + other.digits.size();
-        while (carry > 0 && k < result.digits.size()) {
-            unsigned long long sum = result.digits[k] + carry;
-            result.digits[k] = sum % BASE;
-            carry = sum / BASE;
-            k++;
-        }
-    }
-    
-    result.normalize();
-    return result;
+    size_t midLen = 2 * (hh + 1);
+    subFrom(mid, midLen, r, 2 * h);
+    subFrom(mid, midLen, r + 2 * h, 2 * hh);
+
+    size_t room = 2 * n - h;
+    addInto(r + h, room, mid, std::min(midLen, room));
 }
 
-void BigInteger::divideAbs(const BigInteger& divisor, BigInteger& quotient, BigInteger& remainder) const {
-    if (divisor.isZero()) {
-        throw std::runtime_error("Division by zero");
+// r[0..an+bn) = a[0..an) * b[0..bn); an, bn >= 1; r must not alias a or b
+static void mulLimbs(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    if (a == b && an == bn) {
+        // Squaring: roughly half the limb products
+        sqrKaratsuba(r, a, an);
+        return;
     }
-    
-    quotient = BigInteger();
-    remainder = BigInteger();
-    
-    if (isZero()) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn < KARATSUBA_THRESHOLD) {
+        mulBasecase(r, a, an, b, bn);
+        return;
+    }
+    if (an == bn) {
+        mulKaratsuba(r, a, b, an);
         return;
     }
-    
-    // Long division algorithm
-    for (int i = digits.size() - 1; i >= 0; i--) {
-        // Shift remainder left by BASE (multiply by BASE) and add next digit
-        // In our positional system, multiplying by BASE means shifting all digits up one position
-        if (!remainder.isZero()) {
-            // Insert 0 at the beginning (least significant position) and shift all digits up
-            remainder.digits.insert(remainder.digits.begin(), 0);
-        }
-        
-        // Add current digit at the least significant position
-        if (remainder.isZero()) {
-            remainder.digits.push_back(digits[i]);
+
+    // Unbalanced: multiply bn-sized slices of a by b and accumulate
+    std::fill(r, r + an + bn, 0);
+    std::vector<Limb> partial(2 * bn);
+    for (size_t offset = 0; offset < an; offset += bn) {
+        size_t len = std::min(bn, an - offset);
+        if (len == bn) {
+            mulKaratsuba(partial.data(), a + offset, b, bn);
+        } else {
+            mulLimbs(partial.data(), b, bn, a + offset, len);
+        }
+        addInto(r + offset, an + bn - offset, partial.data(), len + bn);
+    }
+}
+
+// Knuth Algorithm D: q[0..an-bn] = a / b, rem[0..bn) = a % b
+// Requires an >= bn >= 2 and b[bn-1] != 0
+static void divModLimbs(Limb* q, Limb* rem, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    // D1: normalize so the divisor's top bit is set
+    int shift = __builtin_clzll(b[bn - 1]);
+    std::vector<Limb> buffer(an + 1 + bn);
+    Limb* un = buffer.data();
+    Limb* vn = un + an + 1;
+    if (shift == 0) {
+        std::copy(b, b + bn, vn);
+        std::copy(a, a + an, un);
+        un[an] = 0;
+    } else {
+        for (size_t i = bn - 1; i > 0; i--) {
+            vn[i] = (b[i] << shift) | (b[i - 1] >> (64 - shift));
+        }
+        vn[0] = b[0] << shift;
+        un[an] = a[an - 1] >> (64 - shift);
+        for (size_t i = an - 1; i > 0; i--) {
+            un[i] = (a[i] << shift) | (a[i - 1] >> (64 - shift));
+        }
+        un[0] = a[0] << shift;
+    }
+
+    Limb d1 = vn[bn - 1];
+    Limb d0 = vn[bn - 2];
+    for (size_t j = an - bn + 1; j-- > 0; ) {
+        // D3: estimate qhat from the top two limbs, refine with the third
+        Limb u2 = un[j + bn];
+        Limb u1 = un[j + bn - 1];
+        Limb u0 = un[j + bn - 2];
+        Limb qhat, rhat;
+        bool rhatOverflow = false;
+        if (u2 >= d1) {
+            // u2 == d1: the true quotient digit is B-1 or B-2
+            qhat = ~(Limb)0;
+            rhat = u1 + d1;
+            rhatOverflow = rhat < d1;
         } else {
-            remainder.digits[0] += digits[i];
-            // Handle overflow if the addition causes carry
-            if (remainder.digits[0] >= BASE) {
-                long long carry = remainder.digits[0] / BASE;
-                remainder.digits[0] %= BASE;
-                for (size_t j = 1; j < remainder.digits.size() && carry > 0; j++) {
-                    remainder.digits[j] += carry;
-                    carry = remainder.digits[j] / BASE;
-                    remainder.digits[j] %= BASE;
-                }
-                if (carry > 0) {
-                    remainder.digits.push_back(carry);
-                }
-            }
+            qhat = divWide(u2, u1, d1, rhat);
         }
-        
-        remainder.normalize();
-        
-        // Find how many times divisor goes into remainder
-        // Use quotient estimation instead of repeated subtraction
-        int count = 0;
-        
-        // Estimate quotient digit based on leading digits
-        if (!divisor.isZero() && !remainder.isZero()) {
-            long long estimate = 0;
-            
-            if (remainder.digits.size() == divisor.digits.size()) {
-                // Same number of digits - estimate from leading digit
-                estimate = remainder.digits.back() / divisor.digits.back();
-            } 
-            else if (remainder.digits.size() == divisor.digits.size() + 1) {
-                // Remainder is one digit longer - use two leading digits
-                long long high = remainder.digits.back();
-                long long low = (remainder.digits.size() > 1) ? 
-                                remainder.digits[remainder.digits.size() - 2] : 0;
-                long long dividend_est = high * BASE + low;
-                long long divisor_lead = divisor.digits.back();
-                estimate = dividend_est / divisor_lead;
-            }
-            else if (remainder.digits.size() > divisor.digits.size() + 1) {
-                // Remainder is much larger than divisor
-                estimate = BASE - 1;
-            }
-            // else: remainder < divisor, quotient digit is 0
-            
-            // Clamp estimate to valid digit range [0, BASE-1]
-            if (estimate >= BASE) estimate = BASE - 1;
-            if (estimate < 0) estimate = 0;
-            
-            // Verify estimate and adjust if needed using binary search
-            // This prevents O(n) behavior when estimate is significantly off
-            int low = 0;
-            int high = (int)estimate;
-            count = 0;
-            
-            while (low <= high) {
-                int mid = low + (high - low) / 2;
-                
-                // Calculate divisor * mid
-                BigInteger product(mid);
-                product = divisor * product;
-                
-                // Check if mid is valid
-                int cmp = remainder.compareAbs(product);
-                if (cmp >= 0) {
-                    // mid works, but maybe we can go higher
-                    count = mid;
-                    low = mid + 1;
-                } else {
-                    // mid is too high
-                    high = mid - 1;
-                }
-            }
-            
-            // Subtract the final product
-            if (count > 0) {
-                BigInteger product(count);
-                product = divisor * product;
-                remainder = remainder.subtractAbs(product);
-            }
+        while (!rhatOverflow && (DoubleLimb)qhat * d0 > (((DoubleLimb)rhat << 64) | u0)) {
+            qhat--;
+            rhat += d1;
+            rhatOverflow = rhat < d1;
+        }
+
+        // D4: multiply and subtract
+        Limb borrow = subMul1(un + j, vn, bn, qhat);
+        Limb top = un[j + bn];
+        un[j + bn] = top - borrow;
+
+        // D6: add back (rare: qhat was one too large)
+        if (top < borrow) {
+            qhat--;
+            un[j + bn] += addN(un + j, un + j, vn, bn);
         }
-        
-        quotient.digits.push_back(count);
+        q[j] = qhat;
+    }
+
+    // D8: unnormalize the remainder
+    if (shift == 0) {
+        std::copy(un, un + bn, rem);
+    } else {
+        for (size_t i = 0; i < bn - 1; i++) {
+            rem[i] = (un[i] >> shift) | (un[i + 1] << (64 - shift));
+        }
+        rem[bn - 1] = un[bn - 1] >> shift;
     }
-    
-    // Quotient digits are in reverse order
-    std::reverse(quotient.digits.begin(), quotient.digits.end());
-    quotient.normalize();
-    remainder.normalize();
 }
 
-// Comparison operators
+// Compare a[0..n) with b[0..n) as numbers: -1, 0 or 1
+static int compareNScalar(const Limb* a, const Limb* b, size_t n) {
+    for (size_t i = n; i-- > 0; ) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
 
-bool BigInteger::operator==(const BigInteger& other) const {
-    if (negative != other.negative) {
-        return false;
+#if defined(__x86_64__)
+// Long operands that share a long common prefix (x == y tests, Knuth D's
+// remainder checks) are compared four limbs per step with AVX2; only the
+// block holding the first difference is resolved with scalar compares
+__attribute__((target("avx2")))
+static int compareNAvx2(const Limb* a, const Limb* b, size_t n) {
+    size_t i = n;
+    while (i >= 4) {
+        i -= 4;
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        unsigned equalMask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(va, vb)));
+        if (equalMask != 0xF) {
+            size_t k = i + 31 - __builtin_clz(~equalMask & 0xF);
+            return a[k] < b[k] ? -1 : 1;
+        }
     }
-    return digits == other.digits;
+    return compareNScalar(a, b, i);
 }
 
-bool BigInteger::operator!=(const BigInteger& other) const {
-    return !(*this == other);
+// Resolved once at startup; the SIMD path is never taken on CPUs without it
+static bool detectAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
 }
 
-bool BigInteger::operator<(const BigInteger& other) const {
-    if (negative != other.negative) {
-        return negative; // negative < positive
+static const bool cpuHasAvx2 = detectAvx2();
+#endif
+
+static int compareN(const Limb* a, const Limb* b, size_t n) {
+#if defined(__x86_64__)
+    if (n >= SIMD_COMPARE_MIN_LIMBS && cpuHasAvx2) {
+        return compareNAvx2(a, b, n);
     }
-    
-    int cmp = compareAbs(other);
-    return negative ? (cmp > 0) : (cmp < 0);
+#endif
+    return compareNScalar(a, b, n);
 }
 
-bool BigInteger::operator<=(const BigInteger& other) const {
-    return *this < other || *this == other;
+// r[0..n) = (a[0..an) * b[0..bn)) mod B^n: the columns at or above n are
+// never formed
+static void mulLow(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn, size_t n) {
+    std::fill(r, r + n, 0);
+    for (size_t j = 0; j < bn && j < n; j++) {
+        size_t len = std::min(an, n - j);
+        Limb carry = addMul1(r + j, a, len, b[j]);
+        if (j + len < n) {
+            r[j + len] = carry;
+        }
+    }
 }
 
-bool BigInteger::operator>(const BigInteger& other) const {
-    return !(*this <= other);
+// r[0..2n) = a[0..n) * b[0..n) restricted to the columns >= skip (lower
+// columns are left at zero), so only the high limbs of r are meaningful
+static void mulHighColumns(Limb* r, const Limb* a, const Limb* b, size_t n, size_t skip) {
+    std::fill(r, r + 2 * n, 0);
+    for (size_t j = 0; j < n; j++) {
+        size_t start = skip > j ? skip - j : 0;
+        if (start >= n) {
+            continue;
+        }
+        r[j + n] = addMul1(r + j + start, a + start, n - start, b[j]);
+    }
 }
 
-bool BigInteger::operator>=(const BigInteger& other) const {
-    return !(*this < other);
-}
+// Modular multiplication for powMod
+//
+// Both reducers work on residues of exactly k limbs (zero padded) and expose
+// multiply(r, a, b) with r allowed to alias a or b.
 
-// Arithmetic operators
+// Montgomery form for odd moduli: x is stored as x*R mod n with R = 2^(64k),
+// so reduction is k multiply-adds by n instead of a division
+class MontgomeryReducer {
+public:
+    MontgomeryReducer(const Limb* modulus, size_t limbCount)
+        : n(modulus), k(limbCount), product(2 * limbCount + 1) {
+        // Newton iteration for n[0]^-1 mod 2^64 (each step doubles the correct bits)
+        Limb inverse = n[0];
+        for (int i = 0; i < 5; i++) {
+            inverse *= 2 - n[0] * inverse;
+        }
+        nInv = 0 - inverse;
+    }
 
-BigInteger BigInteger::operator+(const BigInteger& other) const {
-    if (negative == other.negative) {
-        // Same sign: add absolute values
-        BigInteger result = addAbs(other);
-        result.negative = negative;
-        result.normalize();
-        return result;
-    } else {
-        // Different signs: subtract absolute values
-        int cmp = compareAbs(other);
-        if (cmp == 0) {
-            return BigInteger(); // Zero
-        } else if (cmp > 0) {
-            BigInteger result = subtractAbs(other);
-            result.negative = negative;
-            result.normalize();
-            return result;
+    void multiply(Limb* r, const Limb* a, const Limb* b) {
+        Limb* t = product.data();
+        mulLimbs(t, a, k, b, k);
+        t[2 * k] = 0;
+        // REDC: clear the low k limbs by adding multiples of n
+        for (size_t i = 0; i < k; i++) {
+            Limb m = t[i] * nInv;
+            Limb carry = addMul1(t + i, n, k, m);
+            addInto(t + i + k, k + 1 - i, &carry, 1);
+        }
+        // t / R < 2n: at most one final subtraction
+        if (t[2 * k] != 0 || compareN(t + k, n, k) >= 0) {
+            subN(r, t + k, n, k);
         } else {
-            BigInteger result = other.subtractAbs(*this);
-            result.negative = other.negative;
-            result.normalize();
-            return result;
+            std::copy(t + k, t + 2 * k, r);
         }
     }
-}
 
-BigInteger BigInteger::operator-(const BigInteger& other) const {
-    return *this + (-other);
-}
+private:
+    const Limb* n;
+    size_t k;
+    Limb nInv;                  // -n^-1 mod 2^64
+    std::vector<Limb> product;
+};
 
-BigInteger BigInteger::operator-() const {
-    BigInteger result(*this);
-    if (!isZero()) {
-        result.negative = !negative;
+// Barrett reduction for even moduli: mu = floor(B^2k / n) turns the quotient
+// estimate into two multiplications (HAC 14.42)
+class BarrettReducer {
+public:
+    BarrettReducer(const Limb* modulus, const Limb* reciprocal, size_t limbCount)
+        : n(modulus), mu(reciprocal), k(limbCount),
+          product(2 * limbCount + 2), estimate(2 * limbCount + 2), quotientTimesN(2 * limbCount + 1),
+          remainder(limbCount + 1) {}
+
+    void multiply(Limb* r, const Limb* a, const Limb* b) {
+        Limb* t = product.data();
+        mulLimbs(t, a, k, b, k);
+
+        // q = ((t >> 64(k-1)) * mu) >> 64(k+1)
+        Limb* q2 = estimate.data();
+        Limb* qn = quotientTimesN.data();
+        const Limb* q3 = q2 + (k + 1);
+        if (k < BARRETT_TRUNCATED_MAX_LIMBS) {
+            // Only the top of q2 and the bottom of q*n matter: skip the other
+            // columns (HAC 14.44); the estimate drops by at most one more
+            mulHighColumns(q2, t + (k - 1), mu, k + 1, k - 1);
+            mulLow(qn, q3, k + 1, n, k, k + 1);
+        } else {
+            mulLimbs(q2, t + (k - 1), k + 1, mu, k + 1);
+            mulLimbs(qn, q3, k + 1, n, k);
+        }
+
+        // r = (t - q*n) mod B^(k+1), then at most three corrections
+        Limb* rem = remainder.data();
+        subN(rem, t, qn, k + 1);
+        while (rem[k] != 0 || compareN(rem, n, k) >= 0) {
+            rem[k] -= subN(rem, rem, n, k);
+        }
+        std::copy(rem, rem + k, r);
     }
-    return result;
-}
 
-BigInteger BigInteger::operator+() const {
-    return *this;
+private:
+    const Limb* n;
+    const Limb* mu;             // k + 1 limbs
+    size_t k;
+    std::vector<Limb> product;
+    std::vector<Limb> estimate;
+    std::vector<Limb> quotientTimesN;
+    std::vector<Limb> remainder;
+};
+
+// mulMod keeps Barrett contexts for the last few moduli it saw: scripts
+// reduce by the same modulus over and over, so the reciprocal (a 2k-by-k
+// division) is paid once per modulus rather than once per product
+static const size_t BARRETT_CACHE_SIZE = 4;
+
+// Stein's binary GCD on single words
+static Limb binaryGcd(Limb u, Limb v) {
+    if (u == 0) return v;
+    if (v == 0) return u;
+    int shift = __builtin_ctzll(u | v);
+    u >>= __builtin_ctzll(u);
+    do {
+        v >>= __builtin_ctzll(v);
+        if (u > v) {
+            std::swap(u, v);
+        }
+        v -= u;
+    } while (v != 0);
+    return u << shift;
 }
 
-BigInteger BigInteger::operator*(const BigInteger& other) const {
-    BigInteger result = multiplyAbs(other);
-    result.negative = (negative != other.negative) && !result.isZero();
-    result.normalize();
-    return result;
+// 64 bits of v[0..n) starting at bit `shift`
+static Limb leadingBits64(const Limb* v, size_t n, size_t shift) {
+    size_t limb = shift / 64;
+    unsigned offset = shift % 64;
+    Limb word = v[limb] >> offset;
+    if (offset != 0 && limb + 1 < n) {
+        word |= v[limb + 1] << (64 - offset);
+    }
+    return word;
 }
 
-BigInteger BigInteger::operator/(const BigInteger& other) const {
-    BigInteger quotient, remainder;
-    divideAbs(other, quotient, remainder);
-    
-    // Truncating division
-    quotient.negative = (negative != other.negative) && !quotient.isZero();
-    quotient.normalize();
-    return quotient;
+// 62 bits of v[0..n) starting at bit `shift` (the Lehmer leading-word window)
+static Limb leadingBits(const Limb* v, size_t n, size_t shift) {
+    return leadingBits64(v, n, shift) & ((Limb(1) << 62) - 1);
 }
 
-BigInteger BigInteger::floorDiv(const BigInteger& other) const {
-    if (other.isZero()) {
-        throw std::runtime_error("Division by zero");
-    }
-    
-    BigInteger quotient, remainder;
-    divideAbs(other, quotient, remainder);
-    
-    // Python floor division floors toward -∞
-    bool differentSigns = (negative != other.negative);
-    bool hasRemainder = !remainder.isZero();
-    
-    if (differentSigns && hasRemainder) {
-        // Adjust quotient down (toward -∞)
-        quotient = quotient + BigInteger(1);
-        quotient.negative = true;
+// out[0..n] = u*x + v*y for cofactors of opposite sign (u*v <= 0) whose
+// combination is known to be non-negative; x and y are both n limbs
+static void cofactorCombination(Limb* out, const Limb* x, int64_t u, const Limb* y, int64_t v, size_t n) {
+    if (v <= 0) {
+        out[n] = mul1(out, x, n, (Limb)u);
+        out[n] -= subMul1(out, y, n, (Limb)(-v));
     } else {
-        quotient.negative = differentSigns && !quotient.isZero();
+        out[n] = mul1(out, y, n, (Limb)v);
+        out[n] -= subMul1(out, x, n, (Limb)(-u));
     }
-    
-    quotient.normalize();
-    return quotient;
 }
 
-BigInteger BigInteger::operator%(const BigInteger& other) const {
-    if (other.isZero()) {
-        throw std::runtime_error("Modulo by zero");
+// result = base^e in the reducer's representation; `one` is 1 in that representation.
+// Left-to-right sliding window over the exponent bits, odd powers precomputed.
+template <typename Reducer>
+static void slidingWindowPow(Reducer& reducer, Limb* result, const Limb* base, const Limb* one,
+                             size_t k, const Limb* e, size_t bits) {
+    auto bit = [e](size_t i) { return (e[i / 64] >> (i % 64)) & 1; };
+    int window = bits <= 24 ? 1 : bits <= 80 ? 3 : bits <= 240 ? 4 : bits <= 672 ? 5 : 6;
+
+    // table[i] = base^(2i+1)
+    size_t tableSize = (size_t)1 << (window - 1);
+    std::vector<Limb> table(tableSize * k);
+    std::copy(base, base + k, table.data());
+    if (tableSize > 1) {
+        std::vector<Limb> square(k);
+        reducer.multiply(square.data(), base, base);
+        for (size_t i = 1; i < tableSize; i++) {
+            reducer.multiply(table.data() + i * k, table.data() + (i - 1) * k, square.data());
+        }
     }
-    
-    BigInteger quotient, remainder;
-    divideAbs(other, quotient, remainder);
-    
-    // Python modulo: sign of result matches sign of divisor
-    bool differentSigns = (negative != other.negative);
-    bool hasRemainder = !remainder.isZero();
-    
-    if (hasRemainder && differentSigns) {
-        // Adjust remainder: r = r - |divisor|
-        remainder = other.subtractAbs(remainder);
-        remainder.negative = other.negative;
-    } else {
-        remainder.negative = negative && !remainder.isZero();
+
+    std::copy(one, one + k, result);
+    bool started = false;
+    size_t i = bits;
+    while (i > 0) {
+        size_t top = i - 1;
+        if (!bit(top)) {
+            if (started) {
+                reducer.multiply(result, result, result);
+            }
+            i--;
+            continue;
+        }
+        // Longest window [low, top] of at most `window` bits that ends in a 1
+        size_t low = top + 1 >= (size_t)window ? top + 1 - window : 0;
+        while (!bit(low)) {
+            low++;
+        }
+        size_t value = 0;
+        for (size_t j = top + 1; j-- > low; ) {
+            value = (value << 1) | bit(j);
+        }
+        const Limb* factor = table.data() + (value >> 1) * k;
+        if (started) {
+            for (size_t j = low; j <= top; j++) {
+                reducer.multiply(result, result, result);
+            }
+            reducer.multiply(result, result, factor);
+        } else {
+            std::copy(factor, factor + k, result);
+            started = true;
+        }
+        i = low;
     }
-    
+}
+
+// Constructors
+
+BigInteger::BigInteger() : limbs(), negative(false) {
+    // Default: represents zero (empty vector)
+}
+
+BigInteger::BigInteger(long long value) : negative(value < 0) {
+    if (value == 0) {
+        // Zero: empty vector
+        return;
+    }
+
+    // Work with absolute value (a single limb always suffices)
+    unsigned long long absValue = (value < 0) ? -(unsigned long long)value : value;
+    limbs.push_back(absValue);
+}
+
+BigInteger::BigInteger(std::string_view str) : negative(false) {
+    // Parse sign
+    size_t startPos = 0;
+    if (!str.empty() && (str[0] == '-' || str[0] == '+')) {
+        negative = (str[0] == '-');
+        startPos = 1;
+    }
+    if (startPos >= str.length()) {
+        throw std::invalid_argument("Invalid number string: " + std::string(str));
+    }
+
+    // Remove leading zeros
+    while (startPos < str.length() && str[startPos] == '0') {
+        startPos++;
+    }
+
+    // Check if it's zero
+    if (startPos >= str.length()) {
+        negative = false;
+        return;
+    }
+
+    // Convert straight out of the caller's buffer (validation happens per
+    // chunk, no substrings)
+    if (!parseDecimal(str.data() + startPos, str.length() - startPos, limbs)) {
+        throw std::invalid_argument("Invalid number string: " + std::string(str));
+    }
+
+    normalize();
+}
+
+BigInteger::BigInteger(const BigInteger& other)
+    : limbs(other.limbs), negative(other.negative) {
+}
+
+BigInteger::BigInteger(BigInteger&& other) noexcept
+    : limbs(std::move(other.limbs)), negative(other.negative) {
+    other.limbs.clear();
+    other.negative = false;
+}
+
+BigInteger& BigInteger::operator=(const BigInteger& other) {
+    if (this != &other) {
+        limbs = other.limbs;
+        negative = other.negative;
+    }
+    return *this;
+}
+
+BigInteger& BigInteger::operator=(BigInteger&& other) noexcept {
+    if (this != &other) {
+        limbs.swap(other.limbs);  // other keeps our old buffer for reuse
+        negative = other.negative;
+        other.limbs.clear();
+        other.negative = false;
+    }
+    return *this;
+}
+
+// Helper methods
+
+void BigInteger::removeLeadingZeros() {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+}
+
+void BigInteger::normalize() {
+    removeLeadingZeros();
+    if (limbs.empty()) {
+        negative = false; // Zero is always positive
+    }
+}
+
+bool BigInteger::isZero() const {
+    return limbs.empty();
+}
+
+bool BigInteger::isNegative() const {
+    return negative && !isZero();
+}
+
+bool BigInteger::fitsInInt() const {
+    // Check if the value fits in a 32-bit signed integer [-2147483648, 2147483647]
+    if (isZero()) return true;
+    if (limbs.size() > 1) return false;
+    return limbs[0] <= (negative ? 2147483648ULL : 2147483647ULL);
+}
+
+int BigInteger::compareAbs(const BigInteger& other) const {
+    if (limbs.size() != other.limbs.size()) {
+        return limbs.size() < other.limbs.size() ? -1 : 1;
+    }
+    return compareN(limbs.data(), other.limbs.data(), limbs.size());
+}
+
+const BigInteger& BigInteger::decimalPower(int level) {
+    // powers[k] = 10^(19 * 2^k), each the square of the previous one
+    // (a deque so references handed out stay valid as the table grows; the
+    // lock lets parallel toString halves share it)
+    static std::deque<BigInteger> powers;
+    static std::mutex powersMutex;
+    std::lock_guard<std::mutex> lock(powersMutex);
+    while ((int)powers.size() <= level) {
+        if (powers.empty()) {
+            BigInteger chunk;
+            chunk.limbs.push_back(DECIMAL_CHUNK);
+            powers.push_back(chunk);
+        } else {
+            powers.push_back(powers.back() * powers.back());
+        }
+    }
+    return powers[level];
+}
+
+void BigInteger::appendDecimal(std::string& out, int level, size_t width) const {
+    // Emits |this| in decimal, left-padded with zeros to `width` digits
+    // (width 0: no padding, i.e. the most significant part)
+    if (level < 0 || limbs.size() <= DECIMAL_BASECASE_DIGITS / DECIMAL_CHUNK_DIGITS) {
+        // Basecase: peel off 19-digit chunks with single-limb division
+        LimbVector work(limbs);
+        std::vector<Limb> chunks;
+        chunks.reserve(work.size() * 64 / 63 + 1);
+        while (!work.empty()) {
+            chunks.push_back(divMod1(work.data(), work.data(), work.size(), DECIMAL_CHUNK));
+            while (!work.empty() && work.back() == 0) {
+                work.pop_back();
+            }
+        }
+
+        char buffer[DECIMAL_CHUNK_DIGITS];
+        std::string digitsText;
+        digitsText.reserve(chunks.size() * DECIMAL_CHUNK_DIGITS);
+        for (size_t i = chunks.size(); i-- > 0; ) {
+            Limb chunk = chunks[i];
+            for (int k = DECIMAL_CHUNK_DIGITS - 1; k >= 0; k--) {
+                buffer[k] = '0' + chunk % 10;
+                chunk /= 10;
+            }
+            if (i == chunks.size() - 1) {
+                // Most significant chunk: no leading zeros
+                int skip = 0;
+                while (skip < DECIMAL_CHUNK_DIGITS - 1 && buffer[skip] == '0') {
+                    skip++;
+                }
+                digitsText.append(buffer + skip, DECIMAL_CHUNK_DIGITS - skip);
+            } else {
+                digitsText.append(buffer, DECIMAL_CHUNK_DIGITS);
+            }
+        }
+        if (width > digitsText.size()) {
+            out.append(width - digitsText.size(), '0');
+        }
+        out += digitsText;
+        return;
+    }
+
+    // Split around 10^(19 * 2^level): this = high * 10^k + low
+    const BigInteger& power = decimalPower(level);
+    size_t lowWidth = (size_t)DECIMAL_CHUNK_DIGITS << level;
+    if (compareAbs(power) < 0) {
+        // Nothing above the split point at this level
+        appendDecimal(out, level - 1, width);
+        return;
+    }
+    BigInteger high, low;
+    divideAbs(power, high, low);
+    size_t highWidth = width > lowWidth ? width - lowWidth : 0;
+    if (limbs.size() >= PARALLEL_DECIMAL_THRESHOLD) {
+        // The low half has a fixed width, so it can be rendered on its own
+        // and appended once the high half is in place
+        std::string lowText;
+        lowText.reserve(lowWidth);
+        forkJoin([&] { low.appendDecimal(lowText, level - 1, lowWidth); },
+                 [&] { high.appendDecimal(out, level - 1, highWidth); });
+        out += lowText;
+    } else {
+        high.appendDecimal(out, level - 1, highWidth);
+        low.appendDecimal(out, level - 1, lowWidth);
+    }
+}
+
+std::string BigInteger::toString() const {
+    if (isZero()) {
+        return "0";
+    }
+
+    std::string result;
+    if (negative) {
+        result = "-";
+    }
+
+    // Start at the largest power whose square could still be <= |this|
+    int level = 0;
+    while ((decimalPower(level).limbs.size() * 2) < limbs.size()) {
+        level++;
+    }
+    appendDecimal(result, level, 0);
+
+    return result;
+}
+
+size_t BigInteger::bitLength() const {
+    if (isZero()) {
+        return 0;
+    }
+    return limbs.size() * 64 - __builtin_clzll(limbs.back());
+}
+
+bool BigInteger::testBit(size_t index) const {
+    size_t limb = index / 64;
+    return limb < limbs.size() && ((limbs[limb] >> (index % 64)) & 1);
+}
+
+long long BigInteger::toLongLong() const {
+    if (isZero()) {
+        return 0;
+    }
+
+    // Low 64 bits only; callers check the range first
+    unsigned long long magnitude = limbs[0];
+    return negative ? (long long)(0 - magnitude) : (long long)magnitude;
+}
+
+double BigInteger::toDouble() const {
+    if (limbs.size() <= 1) {
+        // A single limb converts with one correctly rounded instruction
+        double magnitude = limbs.empty() ? 0.0 : (double)limbs[0];
+        return negative ? -magnitude : magnitude;
+    }
+
+    // Top 64 bits, left-aligned; any nonzero bit below them is folded into
+    // bit 0 as a sticky bit so the hardware conversion (which rounds at bit
+    // 11) still sees exact ties as ties and everything else as off-tie
+    size_t bits = bitLength();
+    size_t shift = bits - 64;
+    Limb top = leadingBits64(limbs.data(), limbs.size(), shift);
+    bool sticky = false;
+    for (size_t i = 0; !sticky && i < shift / 64; i++) {
+        sticky = limbs[i] != 0;
+    }
+    if (!sticky && shift % 64 != 0) {
+        sticky = (limbs[shift / 64] & ((Limb(1) << (shift % 64)) - 1)) != 0;
+    }
+    double magnitude = std::ldexp((double)(top | (sticky ? 1 : 0)), shift > 2048 ? 2048 : (int)shift);
+    return negative ? -magnitude : magnitude;
+}
+
+// SWAR helpers: eight ASCII digits are loaded as one little-endian word,
+// validated and combined with three multiplies instead of eight.
+static inline bool allEightDigits(uint64_t word) {
+    return ((word & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+static inline uint32_t parseEightDigits(uint64_t word) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL;  // 100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL;  // 1 + (10000 << 32)
+    word -= 0x3030303030303030ULL;
+    word = (word * 10) + (word >> 8);
+    word = (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)word;
+}
+
+bool BigInteger::parseChunk(const char* p, int count, uint64_t& out) {
+    // count is 1..DECIMAL_CHUNK_DIGITS; leading digits go through the scalar
+    // loop and each trailing group of eight through the SWAR step
+    uint64_t value = 0;
+    int scalar = count;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    scalar = count % 8;
+#endif
+    for (int i = 0; i < scalar; i++) {
+        unsigned d = (unsigned char)p[i] - '0';
+        if (d > 9) {
+            return false;
+        }
+        value = value * 10 + d;
+    }
+    for (int i = scalar; i < count; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if (!allEightDigits(word)) {
+            return false;
+        }
+        value = value * 100000000u + parseEightDigits(word);
+    }
+    out = value;
+    return true;
+}
+
+bool BigInteger::parseDecimal(const char* p, size_t len, LimbVector& out) {
+    if (len <= DECIMAL_BASECASE_DIGITS) {
+        // Basecase: out = out * 10^19 + chunk, most significant chunk first
+        out.clear();
+        out.reserve(len / DECIMAL_CHUNK_DIGITS + 1);
+        size_t first = len % DECIMAL_CHUNK_DIGITS;
+        if (first == 0) {
+            first = DECIMAL_CHUNK_DIGITS;
+        }
+        for (size_t pos = 0; pos < len; ) {
+            size_t count = (pos == 0) ? first : DECIMAL_CHUNK_DIGITS;
+            uint64_t chunk;
+            if (!parseChunk(p + pos, (int)count, chunk)) {
+                return false;
+            }
+            if (out.empty()) {
+                if (chunk != 0) {
+                    out.push_back(chunk);
+                }
+            } else {
+                Limb carry = mul1(out.data(), out.data(), out.size(), DECIMAL_CHUNK);
+                carry += addInto(out.data(), out.size(), &chunk, 1);
+                if (carry) {
+                    out.push_back(carry);
+                }
+            }
+            pos += count;
+        }
+        return true;
+    }
+
+    // Split off the low 19 * 2^level digits: value = high * 10^(19 * 2^level) + low
+    int level = 0;
+    while (((size_t)DECIMAL_CHUNK_DIGITS << (level + 1)) < len) {
+        level++;
+    }
+    size_t lowLen = (size_t)DECIMAL_CHUNK_DIGITS << level;
+    LimbVector high, low;
+    if (!parseDecimal(p, len - lowLen, high) || !parseDecimal(p + len - lowLen, lowLen, low)) {
+        return false;
+    }
+    while (!high.empty() && high.back() == 0) {
+        high.pop_back();
+    }
+    while (!low.empty() && low.back() == 0) {
+        low.pop_back();
+    }
+
+    const LimbVector& power = decimalPower(level).limbs;
+    if (high.empty()) {
+        out.swap(low);
+        return true;
+    }
+    multiplyLimbs(high, power, out);
+    if (!low.empty()) {
+        out.push_back(0);
+        addInto(out.data(), out.size(), low.data(), low.size());
+    }
+    while (!out.empty() && out.back() == 0) {
+        out.pop_back();
+    }
+    return true;
+}
+
+// Arithmetic helper methods
+
+void BigInteger::addAbsAssign(const BigInteger& other) {
+    // Safe when &other == this: each limb is read before it is overwritten
+    size_t otherSize = other.limbs.size();
+    if (limbs.size() < otherSize) {
+        limbs.resize(otherSize, 0);
+    }
+    if (addInto(limbs.data(), limbs.size(), other.limbs.data(), otherSize)) {
+        limbs.push_back(1);
+    }
+}
+
+void BigInteger::subtractAbsAssign(const BigInteger& other) {
+    // Assumes |this| >= |other|
+    subFrom(limbs.data(), limbs.size(), other.limbs.data(), other.limbs.size());
+    removeLeadingZeros();
+}
+
+void BigInteger::reverseSubtractAbsAssign(const BigInteger& other) {
+    // Assumes |other| > |this|: |this| = |other| - |this|
+    size_t otherSize = other.limbs.size();
+    size_t ownSize = limbs.size();
+    limbs.resize(otherSize, 0);
+    Limb* r = limbs.data();
+    const Limb* o = other.limbs.data();
+    unsigned char borrow = subN(r, o, r, ownSize);
+    for (size_t i = ownSize; i < otherSize; i++) {
+        borrow = subBorrow(borrow, o[i], 0, r[i]);
+    }
+    removeLeadingZeros();
+}
+
+BigInteger BigInteger::addAbs(const BigInteger& other) const {
+    BigInteger result(*this);
+    result.negative = false;
+    result.addAbsAssign(other);
+    return result;
+}
+
+BigInteger BigInteger::subtractAbs(const BigInteger& other) const {
+    // Assumes this >= other (in absolute value)
+    BigInteger result(*this);
+    result.negative = false;
+    result.subtractAbsAssign(other);
+    result.normalize();
+    return result;
+}
+
+void BigInteger::multiplyLimbs(const LimbVector& a, const LimbVector& b,
+                               LimbVector& out) {
+    if (a.empty() || b.empty()) {
+        out.clear();
+        return;
+    }
+    out.resize(a.size() + b.size());
+    mulLimbs(out.data(), a.data(), a.size(), b.data(), b.size());
+
+    while (!out.empty() && out.back() == 0) {
+        out.pop_back();
+    }
+}
+
+BigInteger BigInteger::multiplyAbs(const BigInteger& other) const {
+    BigInteger result;
+    multiplyLimbs(limbs, other.limbs, result.limbs);
+    return result;
+}
+
+void BigInteger::divideAbs(const BigInteger& divisor, BigInteger& quotient, BigInteger& remainder) const {
+    if (divisor.isZero()) {
+        throw std::runtime_error("Division by zero");
+    }
+
+    if (compareAbs(divisor) < 0) {
+        // |this| < |divisor|: quotient 0, remainder |this|
+        remainder.limbs = limbs;
+        remainder.negative = false;
+        quotient = BigInteger();
+        return;
+    }
+
+    size_t an = limbs.size();
+    size_t bn = divisor.limbs.size();
+    LimbVector q;
+    q.resize(an - bn + 1);
+    if (bn == 1) {
+        // Short division: one hardware divide per limb
+        Limb rem = divMod1(q.data(), limbs.data(), an, divisor.limbs[0]);
+        remainder.limbs.clear();
+        remainder.limbs.push_back(rem);
+    } else {
+        LimbVector r;
+        r.resize(bn);
+        divModLimbs(q.data(), r.data(), limbs.data(), an, divisor.limbs.data(), bn);
+        remainder.limbs.swap(r);
+    }
+    quotient.limbs.swap(q);
+    quotient.negative = false;
+    remainder.negative = false;
+    quotient.normalize();
     remainder.normalize();
+}
+
+// Comparison operators
+
+bool BigInteger::operator==(const BigInteger& other) const {
+    if (negative != other.negative) {
+        return false;
+    }
+    return limbs == other.limbs;
+}
+
+bool BigInteger::operator!=(const BigInteger& other) const {
+    return !(*this == other);
+}
+
+bool BigInteger::operator<(const BigInteger& other) const {
+    if (negative != other.negative) {
+        return negative; // negative < positive
+    }
+
+    int cmp = compareAbs(other);
+    return negative ? (cmp > 0) : (cmp < 0);
+}
+
+bool BigInteger::operator<=(const BigInteger& other) const {
+    return *this < other || *this == other;
+}
+
+bool BigInteger::operator>(const BigInteger& other) const {
+    return !(*this <= other);
+}
+
+bool BigInteger::operator>=(const BigInteger& other) const {
+    return !(*this < other);
+}
+
+bool BigInteger::operator==(long long value) const {
+    return compare(value) == 0;
+}
+
+bool BigInteger::operator!=(long long value) const {
+    return compare(value) != 0;
+}
+
+int BigInteger::compare(long long value) const {
+    bool valueNegative = value < 0;
+    if (isNegative() != valueNegative) {
+        return valueNegative ? 1 : -1;
+    }
+    // Same sign: compare magnitudes, reversed for negatives
+    uint64_t magnitude = valueNegative ? 0 - (uint64_t)value : (uint64_t)value;
+    int cmp;
+    if (limbs.size() > 1) {
+        cmp = 1;
+    } else {
+        uint64_t own = limbs.empty() ? 0 : limbs[0];
+        cmp = own < magnitude ? -1 : (own > magnitude ? 1 : 0);
+    }
+    return valueNegative ? -cmp : cmp;
+}
+
+int BigInteger::compare(double value) const {
+    // Infinity is tested through its exponent bits: -Ofast implies
+    // -ffinite-math-only, which folds std::isinf to false
+    uint64_t representation;
+    std::memcpy(&representation, &value, sizeof(representation));
+    if (((representation >> 52) & 0x7FF) == 0x7FF) {
+        return value > 0 ? -1 : 1;
+    }
+    int sign = isZero() ? 0 : (negative ? -1 : 1);
+    int valueSign = value > 0 ? 1 : (value < 0 ? -1 : 0);
+    if (sign != valueSign) {
+        return sign < valueSign ? -1 : 1;
+    }
+    if (sign == 0) {
+        return 0;
+    }
+
+    // Same sign: |value| lies in [2^(exponent-1), 2^exponent), so unless the
+    // bit lengths match the magnitudes are ordered without looking at limbs
+    double magnitude = std::fabs(value);
+    int exponent;
+    std::frexp(magnitude, &exponent);
+    size_t bits = bitLength();
+    int cmp;
+    if (exponent <= 0 || bits != (size_t)exponent) {
+        cmp = exponent <= 0 || bits > (size_t)exponent ? 1 : -1;
+    } else {
+        // Equal bit lengths: the integer part of |value| is exactly a 53-bit
+        // mantissa shifted left, so compare limbs against it, then the fraction
+        double integral = std::floor(magnitude);
+        int shift = exponent - 53;
+        uint64_t mantissa = shift >= 0 ? (uint64_t)std::ldexp(integral, -shift) : (uint64_t)integral;
+        if (shift < 0) {
+            shift = 0;
+        }
+        BigInteger whole;
+        whole.limbs.assign(limbs.size(), 0);
+        whole.limbs[shift / 64] = mantissa << (shift % 64);
+        if (shift % 64 != 0 && shift / 64 + 1 < (int)limbs.size()) {
+            whole.limbs[shift / 64 + 1] = mantissa >> (64 - shift % 64);
+        }
+        cmp = compareAbs(whole);
+        if (cmp == 0 && integral != magnitude) {
+            cmp = -1;
+        }
+    }
+    return negative ? -cmp : cmp;
+}
+
+// Arithmetic operators
+
+BigInteger BigInteger::operator+(const BigInteger& other) const {
+    BigInteger result(*this);
+    result += other;
+    return result;
+}
+
+BigInteger BigInteger::operator-(const BigInteger& other) const {
+    BigInteger result(*this);
+    result -= other;
+    return result;
+}
+
+BigInteger BigInteger::operator-() const {
+    BigInteger result(*this);
+    if (!isZero()) {
+        result.negative = !negative;
+    }
+    return result;
+}
+
+BigInteger BigInteger::operator+() const {
+    return *this;
+}
+
+BigInteger& BigInteger::negate() {
+    if (!isZero()) {
+        negative = !negative;
+    }
+    return *this;
+}
+
+BigInteger BigInteger::sum(const std::vector<BigInteger>& operands, const std::vector<bool>& subtract) {
+    size_t width = 0;
+    for (const BigInteger& operand : operands) {
+        width = std::max(width, operand.limbs.size());
+    }
+    BigInteger result;
+    result.limbs.assign(width, 0);
+    Limb* out = result.limbs.data();
+
+    // Every operand is added into (or subtracted from) one block of the output
+    // before the next block starts. The carries and borrows out of a block net
+    // to a small signed count, which enters the next block at its bottom limb
+    long long carry = 0;
+    for (size_t start = 0; start < width; start += SUM_BLOCK_LIMBS) {
+        size_t blockSize = std::min(SUM_BLOCK_LIMBS, width - start);
+        Limb* block = out + start;
+        long long blockCarry = 0;
+        Limb incoming = (Limb)(carry < 0 ? -carry : carry);
+        if (carry > 0) {
+            blockCarry += addInto(block, blockSize, &incoming, 1);
+        } else if (carry < 0) {
+            blockCarry -= subFrom(block, blockSize, &incoming, 1);
+        }
+        for (size_t j = 0; j < operands.size(); j++) {
+            const LimbVector& l = operands[j].limbs;
+            if (l.size() <= start) {
+                continue;
+            }
+            size_t n = std::min(blockSize, l.size() - start);
+            if (operands[j].negative != subtract[j]) {
+                blockCarry -= subFrom(block, blockSize, l.data() + start, n);
+            } else {
+                blockCarry += addInto(block, blockSize, l.data() + start, n);
+            }
+        }
+        carry = blockCarry;
+    }
+
+    if (carry > 0) {
+        result.limbs.push_back((Limb)carry);
+    } else if (carry < 0) {
+        // Negative total: with the borrow count as top limb the buffer holds
+        // its two's complement, so negate it in place
+        result.limbs.push_back((Limb)carry);
+        unsigned char c = 1;
+        for (Limb& limb : result.limbs) {
+            c = addCarry(c, ~limb, 0, limb);
+        }
+        result.negative = true;
+    }
+    result.normalize();
+    return result;
+}
+
+BigInteger BigInteger::operator*(const BigInteger& other) const {
+    BigInteger result = multiplyAbs(other);
+    result.negative = (negative != other.negative) && !result.isZero();
+    result.normalize();
+    return result;
+}
+
+BigInteger BigInteger::operator/(const BigInteger& other) const {
+    BigInteger quotient, remainder;
+    divideAbs(other, quotient, remainder);
+
+    // Truncating division
+    quotient.negative = (negative != other.negative) && !quotient.isZero();
+    quotient.normalize();
+    return quotient;
+}
+
+BigInteger BigInteger::floorDiv(const BigInteger& other) const {
+    BigInteger result(*this);
+    result.floorDivAssign(other);
+    return result;
+}
+
+BigInteger BigInteger::operator%(const BigInteger& other) const {
+    if (other.limbs.size() == 1) {
+        // Single-limb divisor: reduce straight from our limbs, no copy of |this|
+        BigInteger result;
+        result.limbs.push_back(mod1(limbs.data(), limbs.size(), other.limbs[0]));
+        result.negative = negative;
+        result.modScalarAssign(other.limbs[0], other.negative);
+        return result;
+    }
+    BigInteger result(*this);
+    result.modAssign(other);
+    return result;
+}
+
+// In-place arithmetic
+
+void BigInteger::addSignedAssign(const BigInteger& other, bool otherNegative) {
+    if (negative == otherNegative) {
+        // Same sign: add absolute values
+        addAbsAssign(other);
+    } else {
+        // Different signs: subtract the smaller magnitude from the larger
+        int cmp = compareAbs(other);
+        if (cmp == 0) {
+            limbs.clear();
+        } else if (cmp > 0) {
+            subtractAbsAssign(other);
+        } else {
+            reverseSubtractAbsAssign(other);
+            negative = otherNegative;
+        }
+    }
+    normalize();
+}
+
+BigInteger& BigInteger::operator+=(const BigInteger& other) {
+    addSignedAssign(other, other.negative);
+    return *this;
+}
+
+BigInteger& BigInteger::operator-=(const BigInteger& other) {
+    if (this == &other) {
+        limbs.clear();
+        negative = false;
+        return *this;
+    }
+    addSignedAssign(other, !other.negative && !other.isZero());
+    return *this;
+}
+
+BigInteger& BigInteger::operator*=(const BigInteger& other) {
+    // A product cannot be formed over its own operand, so it is built in a
+    // scratch buffer and swapped in; our old limbs become the next scratch
+    static thread_local LimbVector scratch;
+    multiplyLimbs(limbs, other.limbs, scratch);
+    limbs.swap(scratch);
+    negative = (negative != other.negative);
+    normalize();
+    return *this;
+}
+
+// Scalar arithmetic
+
+void BigInteger::addScalarAssign(uint64_t magnitude, bool scalarNegative) {
+    if (magnitude == 0) {
+        return;
+    }
+    if (isZero()) {
+        limbs.push_back(magnitude);
+        negative = scalarNegative;
+    } else if (negative == scalarNegative) {
+        if (addInto(limbs.data(), limbs.size(), &magnitude, 1)) {
+            limbs.push_back(1);
+        }
+    } else if (limbs.size() > 1 || limbs[0] >= magnitude) {
+        subFrom(limbs.data(), limbs.size(), &magnitude, 1);
+    } else {
+        limbs[0] = magnitude - limbs[0];
+        negative = scalarNegative;
+    }
+    normalize();
+}
+
+uint64_t BigInteger::divideAbsScalarAssign(uint64_t divisor) {
+    uint64_t remainder = divMod1(limbs.data(), limbs.data(), limbs.size(), divisor);
+    removeLeadingZeros();
     return remainder;
 }
 
+BigInteger& BigInteger::operator+=(long long value) {
+    addScalarAssign(value < 0 ? 0 - (uint64_t)value : (uint64_t)value, value < 0);
+    return *this;
+}
+
+BigInteger& BigInteger::operator-=(long long value) {
+    // -value may not be representable, so flip the sign of the magnitude instead
+    addScalarAssign(value < 0 ? 0 - (uint64_t)value : (uint64_t)value, value > 0);
+    return *this;
+}
+
+BigInteger& BigInteger::operator*=(long long value) {
+    if (value == 0 || isZero()) {
+        limbs.clear();
+        negative = false;
+        return *this;
+    }
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    Limb carry = mul1(limbs.data(), limbs.data(), limbs.size(), magnitude);
+    if (carry) {
+        limbs.push_back(carry);
+    }
+    negative = (negative != (value < 0));
+    return *this;
+}
+
+void BigInteger::floorDivScalarAssign(uint64_t magnitude, bool divisorNegative) {
+    bool differentSigns = (negative != divisorNegative);
+    uint64_t remainder = divideAbsScalarAssign(magnitude);
+    if (differentSigns && remainder != 0) {
+        // Round the magnitude up: floors toward -∞ for a negative quotient
+        addScalarAssign(1, negative);
+    }
+    negative = differentSigns;
+    normalize();
+}
+
+void BigInteger::modScalarAssign(uint64_t magnitude, bool divisorNegative) {
+    uint64_t remainder = mod1(limbs.data(), limbs.size(), magnitude);
+    // Python modulo: sign of result matches sign of divisor
+    if (remainder != 0 && negative != divisorNegative) {
+        remainder = magnitude - remainder;
+    }
+    limbs.clear();
+    if (remainder != 0) {
+        limbs.push_back(remainder);
+    }
+    negative = divisorNegative && remainder != 0;
+}
+
+BigInteger& BigInteger::floorDivAssign(long long divisor) {
+    if (divisor == 0) {
+        throw std::runtime_error("Division by zero");
+    }
+    floorDivScalarAssign(divisor < 0 ? 0 - (uint64_t)divisor : (uint64_t)divisor, divisor < 0);
+    return *this;
+}
+
+BigInteger& BigInteger::modAssign(long long divisor) {
+    if (divisor == 0) {
+        throw std::runtime_error("Modulo by zero");
+    }
+    modScalarAssign(divisor < 0 ? 0 - (uint64_t)divisor : (uint64_t)divisor, divisor < 0);
+    return *this;
+}
+
+long long BigInteger::operator%(long long divisor) const {
+    if (divisor == 0) {
+        throw std::runtime_error("Modulo by zero");
+    }
+    uint64_t magnitude = divisor < 0 ? 0 - (uint64_t)divisor : (uint64_t)divisor;
+    uint64_t remainder = mod1(limbs.data(), limbs.size(), magnitude);
+    // Python modulo: sign of result matches sign of divisor
+    if (remainder != 0 && negative != (divisor < 0)) {
+        remainder = magnitude - remainder;
+    }
+    return divisor < 0 ? -(long long)remainder : (long long)remainder;
+}
+
+BigInteger BigInteger::operator+(long long value) const {
+    BigInteger result(*this);
+    result += value;
+    return result;
+}
+
+BigInteger BigInteger::operator-(long long value) const {
+    BigInteger result(*this);
+    result -= value;
+    return result;
+}
+
+BigInteger BigInteger::operator*(long long value) const {
+    BigInteger result(*this);
+    result *= value;
+    return result;
+}
+
+BigInteger BigInteger::floorDiv(long long divisor) const {
+    BigInteger result(*this);
+    result.floorDivAssign(divisor);
+    return result;
+}
+
+BigInteger& BigInteger::floorDivAssign(const BigInteger& other) {
+    if (other.isZero()) {
+        throw std::runtime_error("Division by zero");
+    }
+    if (other.limbs.size() == 1) {
+        // Single-limb divisor: short division in place, no temporaries
+        floorDivScalarAssign(other.limbs[0], other.negative);
+        return *this;
+    }
+
+    BigInteger quotient, remainder;
+    divideAbs(other, quotient, remainder);
+
+    // Python floor division floors toward -∞
+    bool differentSigns = (negative != other.negative);
+    if (differentSigns && !remainder.isZero()) {
+        // Adjust quotient down (toward -∞): |q| + 1 with negative sign
+        static const BigInteger one(1);
+        quotient.addAbsAssign(one);
+    }
+
+    limbs.swap(quotient.limbs);
+    negative = differentSigns;
+    normalize();
+    return *this;
+}
+
+BigInteger& BigInteger::modAssign(const BigInteger& other) {
+    if (other.isZero()) {
+        throw std::runtime_error("Modulo by zero");
+    }
+    if (other.limbs.size() == 1) {
+        modScalarAssign(other.limbs[0], other.negative);
+        return *this;
+    }
+
+    BigInteger quotient, remainder;
+    divideAbs(other, quotient, remainder);
+
+    // Python modulo: sign of result matches sign of divisor
+    bool differentSigns = (negative != other.negative);
+    bool resultNegative = negative;
+    if (!remainder.isZero() && differentSigns) {
+        // Adjust remainder: r = |divisor| - r
+        remainder.reverseSubtractAbsAssign(other);
+        resultNegative = other.negative;
+    }
+
+    limbs.swap(remainder.limbs);
+    negative = resultNegative;
+    normalize();
+    return *this;
+}
+
+// Number theory
+
+BigInteger BigInteger::pow(uint64_t exponent) const {
+    if (exponent == 0) {
+        return BigInteger(1);
+    }
+    if (isZero() || exponent == 1) {
+        return *this;
+    }
+
+    BigInteger result;
+    if (limbs.size() == 1 && (limbs[0] & (limbs[0] - 1)) == 0) {
+        // |base| = 2^k: the result is a single bit
+        uint64_t k = __builtin_ctzll(limbs[0]);
+        if (k != 0 && exponent > UINT64_MAX / k) {
+            throw std::runtime_error("OverflowError: exponent too large");
+        }
+        uint64_t bit = k * exponent;
+        result.limbs.resize(bit / 64 + 1, 0);
+        result.limbs.back() = Limb(1) << (bit % 64);
+    } else if (limbs.size() == 1) {
+        // Single-limb base: left-to-right binary; the multiply step is a
+        // scalar pass, so windows would not save anything
+        Limb b = limbs[0];
+        result.limbs.push_back(b);
+        for (int i = 62 - __builtin_clzll(exponent); i >= 0; i--) {
+            result *= result;
+            if ((exponent >> i) & 1) {
+                Limb carry = mul1(result.limbs.data(), result.limbs.data(), result.limbs.size(), b);
+                if (carry) {
+                    result.limbs.push_back(carry);
+                }
+            }
+        }
+    } else {
+        // Left-to-right sliding window over odd powers base^1, base^3, ...
+        BigInteger base = *this;
+        base.negative = false;
+        int bits = 64 - __builtin_clzll(exponent);
+        int window = bits <= 6 ? 1 : bits <= 24 ? 3 : 4;
+        std::vector<BigInteger> table(size_t(1) << (window - 1));
+        table[0] = base;
+        if (table.size() > 1) {
+            BigInteger square = base;
+            square *= base;
+            for (size_t i = 1; i < table.size(); i++) {
+                table[i] = table[i - 1] * square;
+            }
+        }
+
+        bool started = false;
+        int i = bits - 1;
+        while (i >= 0) {
+            if (!((exponent >> i) & 1)) {
+                result *= result;
+                i--;
+                continue;
+            }
+            int low = std::max(i - window + 1, 0);
+            while (!((exponent >> low) & 1)) {
+                low++;
+            }
+            uint64_t value = (exponent >> low) & ((uint64_t(1) << (i - low + 1)) - 1);
+            if (started) {
+                for (int j = low; j <= i; j++) {
+                    result *= result;
+                }
+                result *= table[value >> 1];
+            } else {
+                result = table[value >> 1];
+                started = true;
+            }
+            i = low - 1;
+        }
+    }
+
+    result.negative = negative && (exponent & 1);
+    result.normalize();
+    return result;
+}
+
+void BigInteger::setMaxThreads(unsigned count) {
+    helperLimit = count > 1 ? count - 1 : 0;
+}
+
+BigInteger BigInteger::shiftedLimbs(size_t count) const {
+    BigInteger result;
+    if (isZero()) {
+        return result;
+    }
+    result.limbs.resize(count + limbs.size(), 0);
+    std::copy(limbs.begin(), limbs.end(), result.limbs.begin() + count);
+    return result;
+}
+
+BigInteger BigInteger::modInverse(const BigInteger& value, const BigInteger& modulus) {
+    // Extended Euclid on (value, modulus); modulus > 1, 0 <= value < modulus
+    BigInteger oldR = value, r = modulus;
+    BigInteger oldS(1), s;
+    while (!r.isZero()) {
+        BigInteger q = oldR.floorDiv(r);
+        BigInteger next = oldR - q * r;
+        oldR = std::move(r);
+        r = std::move(next);
+        next = oldS - q * s;
+        oldS = std::move(s);
+        s = std::move(next);
+    }
+    if (oldR != BigInteger(1)) {
+        throw std::runtime_error("ValueError: base is not invertible for the given modulus");
+    }
+    return oldS % modulus;
+}
+
+BigInteger BigInteger::powMod(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus) {
+    if (modulus.isZero()) {
+        throw std::runtime_error("ValueError: pow() 3rd argument cannot be 0");
+    }
+
+    // Work modulo |modulus| with a reduced, non-negative base
+    BigInteger m = modulus;
+    m.negative = false;
+    BigInteger b = base % m;
+    BigInteger e = exponent;
+    if (e.isNegative()) {
+        if (m == BigInteger(1)) {
+            return BigInteger();
+        }
+        b = modInverse(b, m);
+        e.negative = false;
+    }
+
+    BigInteger result;
+    if (m == BigInteger(1)) {
+        // Everything is 0 mod 1
+    } else if (e.isZero()) {
+        result = BigInteger(1);
+    } else if (!b.isZero()) {
+        size_t k = m.limbs.size();
+        std::vector<Limb> acc(k), baseForm(k), oneForm(k);
+        if (m.limbs[0] & 1) {
+            // Enter Montgomery form: x -> x * R mod m
+            BigInteger bR = b.shiftedLimbs(k) % m;
+            BigInteger oneR = BigInteger(1).shiftedLimbs(k) % m;
+            std::copy(bR.limbs.begin(), bR.limbs.end(), baseForm.begin());
+            std::copy(oneR.limbs.begin(), oneR.limbs.end(), oneForm.begin());
+
+            MontgomeryReducer reducer(m.limbs.data(), k);
+            slidingWindowPow(reducer, acc.data(), baseForm.data(), oneForm.data(), k,
+                             e.limbs.data(), e.bitLength());
+
+            // Leave Montgomery form: multiply by plain 1
+            std::vector<Limb> plainOne(k, 0);
+            plainOne[0] = 1;
+            reducer.multiply(acc.data(), acc.data(), plainOne.data());
+        } else if (m.limbs.back() == 1 &&
+                   std::all_of(m.limbs.begin(), m.limbs.end() - 1, [](Limb x) { return x == 0; })) {
+            // m = 2^(64(k-1)): mu would need k + 2 limbs, but the low k - 1
+            // limbs of the plain product already are the residue
+            BigInteger power(1);
+            for (size_t bitIndex = e.bitLength(); bitIndex-- > 0; ) {
+                power *= power;
+                power.limbs.resize(std::min(power.limbs.size(), k - 1));
+                if (e.testBit(bitIndex)) {
+                    power *= b;
+                    power.limbs.resize(std::min(power.limbs.size(), k - 1));
+                }
+                power.normalize();
+            }
+            acc.assign(k, 0);
+            std::copy(power.limbs.begin(), power.limbs.end(), acc.begin());
+        } else {
+            BigInteger mu = BigInteger(1).shiftedLimbs(2 * k).floorDiv(m);
+            std::vector<Limb> reciprocal(k + 1, 0);
+            std::copy(mu.limbs.begin(), mu.limbs.end(), reciprocal.begin());
+            std::copy(b.limbs.begin(), b.limbs.end(), baseForm.begin());
+            oneForm[0] = 1;
+
+            BarrettReducer reducer(m.limbs.data(), reciprocal.data(), k);
+            slidingWindowPow(reducer, acc.data(), baseForm.data(), oneForm.data(), k,
+                             e.limbs.data(), e.bitLength());
+        }
+        result.limbs.resize(k);
+        std::copy(acc.begin(), acc.end(), result.limbs.begin());
+        result.normalize();
+    }
+
+    // Python: a non-zero result takes the sign of the modulus
+    if (modulus.negative && !result.isZero()) {
+        result -= m;
+    }
+    return result;
+}
+
+BigInteger BigInteger::mulMod(const BigInteger& a, const BigInteger& b, const BigInteger& modulus) {
+    if (modulus.isZero()) {
+        throw std::runtime_error("Modulo by zero");
+    }
+
+    // result = (|a| * |b|) mod |modulus|; signs are applied at the end
+    size_t k = modulus.limbs.size();
+    BigInteger result;
+    if (a.isZero() || b.isZero()) {
+        return result;
+    } else if (k == 1) {
+        // Reduce each factor, then one two-by-one division
+        Limb d = modulus.limbs[0];
+        Limb x = mod1(a.limbs.data(), a.limbs.size(), d);
+        Limb y = mod1(b.limbs.data(), b.limbs.size(), d);
+        DoubleLimb product = (DoubleLimb)x * y;
+        Limb rem;
+        divWide((Limb)(product >> 64), (Limb)product, d, rem);
+        if (rem != 0) {
+            result.limbs.push_back(rem);
+        }
+    } else if (a.compareAbs(modulus) < 0 && b.compareAbs(modulus) < 0 &&
+               !(modulus.limbs.back() == 1 &&
+                 std::all_of(modulus.limbs.begin(), modulus.limbs.end() - 1, [](Limb x) { return x == 0; }))) {
+        // Reduced factors: Barrett with a cached reciprocal (a modulus of
+        // exactly B^(k-1) would need a wider reciprocal and takes the path below)
+        struct CacheEntry {
+            LimbVector modulus;
+            std::vector<Limb> reciprocal;
+            std::unique_ptr<BarrettReducer> reducer;
+        };
+        static thread_local CacheEntry cache[BARRETT_CACHE_SIZE];
+        static thread_local size_t nextSlot = 0;
+
+        CacheEntry* entry = nullptr;
+        for (CacheEntry& candidate : cache) {
+            if (candidate.reducer && candidate.modulus == modulus.limbs) {
+                entry = &candidate;
+                break;
+            }
+        }
+        if (!entry) {
+            entry = &cache[nextSlot];
+            nextSlot = (nextSlot + 1) % BARRETT_CACHE_SIZE;
+            BigInteger m = modulus;
+            m.negative = false;
+            BigInteger mu = BigInteger(1).shiftedLimbs(2 * k).floorDiv(m);
+            entry->modulus = modulus.limbs;
+            entry->reciprocal.assign(k + 1, 0);
+            std::copy(mu.limbs.begin(), mu.limbs.end(), entry->reciprocal.begin());
+            entry->reducer.reset(new BarrettReducer(entry->modulus.data(), entry->reciprocal.data(), k));
+        }
+
+        result.limbs.assign(3 * k, 0);
+        Limb* x = result.limbs.data() + k;
+        Limb* y = x + k;
+        std::copy(a.limbs.begin(), a.limbs.end(), x);
+        if (a.limbs == b.limbs) {
+            // x * x: hand the same pointer twice so the squaring kernel is used
+            y = x;
+        } else {
+            std::copy(b.limbs.begin(), b.limbs.end(), y);
+        }
+        entry->reducer->multiply(result.limbs.data(), x, y);
+        result.limbs.resize(k);
+        result.normalize();
+    } else {
+        BigInteger quotient;
+        a.multiplyAbs(b).divideAbs(modulus, quotient, result);
+    }
+
+    // Python modulo: a non-zero result takes the modulus' sign
+    if (!result.isZero() && (a.negative != b.negative) != modulus.negative) {
+        result.reverseSubtractAbsAssign(modulus);
+    }
+    result.negative = modulus.negative && !result.isZero();
+    return result;
+}
+
+BigInteger BigInteger::gcd(const BigInteger& a, const BigInteger& b) {
+    std::vector<Limb> x(a.limbs.begin(), a.limbs.end());
+    std::vector<Limb> y(b.limbs.begin(), b.limbs.end());
+    auto trim = [](std::vector<Limb>& v) {
+        while (!v.empty() && v.back() == 0) {
+            v.pop_back();
+        }
+    };
+    if (x.size() < y.size() || (x.size() == y.size() && compareN(x.data(), y.data(), x.size()) < 0)) {
+        x.swap(y);
+    }
+
+    // Lehmer: run Euclid on the leading 62 bits with cofactors (A B; C D) and
+    // apply the whole batch of quotients to the full numbers at once
+    std::vector<Limb> nextX, nextY;
+    while (y.size() >= 2) {
+        size_t n = x.size();
+        y.resize(n, 0);
+        size_t shift = n * 64 - __builtin_clzll(x[n - 1]) - 62;
+        int64_t xh = (int64_t)leadingBits(x.data(), n, shift);
+        int64_t yh = (int64_t)leadingBits(y.data(), n, shift);
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        while (yh + C > 0 && yh + D > 0) {
+            // Collins' test: the quotient is exact only if both bounds agree
+            int64_t q = (xh + A) / (yh + C);
+            if (q != (xh + B) / (yh + D)) {
+                break;
+            }
+            int64_t t = A - q * C; A = C; C = t;
+            t = B - q * D; B = D; D = t;
+            t = xh - q * yh; xh = yh; yh = t;
+        }
+
+        if (B == 0) {
+            // No single-word step was safe: one full division x, y = y, x mod y
+            trim(y);
+            std::vector<Limb> quotient(x.size() - y.size() + 1), remainder(y.size());
+            if (y.size() == 1) {
+                remainder[0] = divMod1(quotient.data(), x.data(), x.size(), y[0]);
+            } else {
+                divModLimbs(quotient.data(), remainder.data(), x.data(), x.size(), y.data(), y.size());
+            }
+            x.swap(y);
+            y.swap(remainder);
+        } else {
+            nextX.resize(n + 1);
+            nextY.resize(n + 1);
+            cofactorCombination(nextX.data(), x.data(), A, y.data(), B, n);
+            cofactorCombination(nextY.data(), x.data(), C, y.data(), D, n);
+            x.swap(nextX);
+            y.swap(nextY);
+        }
+        trim(x);
+        trim(y);
+    }
+
+    // Single word left: one short division, then binary GCD
+    BigInteger result;
+    if (y.empty()) {
+        result.limbs.resize(x.size());
+        std::copy(x.begin(), x.end(), result.limbs.begin());
+    } else {
+        Limb rest = x.size() == 1 ? x[0] % y[0] : divMod1(x.data(), x.data(), x.size(), y[0]);
+        result.limbs.push_back(binaryGcd(y[0], rest));
+    }
+    result.normalize();
+    return result;
+}
+
 // I/O operators
 
 std::ostream& operator<<(std::ostream& os, const BigInteger& bi) {
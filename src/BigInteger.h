@@ -2,33 +2,46 @@
 #ifndef PYTHON_INTERPRETER_BIGINTEGER_H
 #define PYTHON_INTERPRETER_BIGINTEGER_H
 
-#include <vector>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <iostream>
+#include <vector>
+#include "SmallVector.h"
 
 /**
  * BigInteger class for arbitrary precision integer arithmetic.
  * 
  * Design Philosophy:
  * - Supports integers with thousands of digits (requirement from BigIntegerTest cases)
- * - Uses vector of digits for storage (base 10^9 for efficiency)
+ * - Uses binary 64-bit limbs so arithmetic maps onto hardware carry chains
  * - Implements Python-compatible floor division (floors toward -∞)
  * - Handles both positive and negative numbers
  * - Integrates with Value type system using std::variant
  * 
  * Storage Strategy:
- * - Vector stores digits in reverse order (least significant first)
- * - Each element is a "digit" in base 10^9 (0 to 999,999,999)
- * - Base 10^9 chosen for:
- *   1. Efficient storage (32-bit int can hold up to ~2.1B)
- *   2. Fast multiplication (two 10^9 values fit in 64-bit)
- *   3. Reasonable conversion to/from decimal strings
+ * - Magnitude stored as limbs in base 2^64, least significant first
+ * - Base 2^64 chosen for:
+ *   1. No wasted bits: every limb is a full machine word
+ *   2. Carries are plain overflow bits (add-with-carry), no division by a base
+ *   3. Limb products fit exactly in unsigned __int128
+ * - Decimal only exists at the edges: the string constructor and toString()
+ *   convert in chunks of 19 digits, divide-and-conquer for long numbers
  * - Separate sign flag (true = negative, false = positive/zero)
  * - Zero is represented as empty vector with sign = false
+ * - Limbs live in a SmallVector with INLINE_LIMBS slots inside the object, so
+ *   values up to 256 bits (int overflow promotions, temporaries in the
+ *   evaluator's fallback paths) never touch the heap
+ * 
+ * Example: 1234567890123456789012345
+ * - Stored as: [0x0F36A6443DE2DF79, 0x1056E] with sign = false
+ * - Represents: 0x1056E * 2^64 + 0x0F36A6443DE2DF79
  * 
- * Example: 1234567890123456789
- * - Stored as: [567890123, 234, 1] with sign = false
- * - Represents: 1 * 10^18 + 234 * 10^9 + 567890123
+ * Algorithms:
+ * - Multiplication: schoolbook below KARATSUBA_THRESHOLD limbs, Karatsuba above
+ * - Division: Knuth's Algorithm D (TAOCP Vol. 2, 4.3.1) on normalized limbs
+ * - Very large products and decimal conversions fork their independent halves
+ *   onto helper threads (see setMaxThreads); results are identical to serial
  * 
  * Python Floor Division Semantics:
  * - Python's // operator always floors toward negative infinity
@@ -45,11 +58,13 @@ public:
     // Constructors
     BigInteger();                          // Default: creates 0
     BigInteger(long long value);           // From standard integer
-    BigInteger(const std::string& str);    // From decimal string
+    BigInteger(std::string_view str);      // From decimal string (optional sign)
     BigInteger(const BigInteger& other);   // Copy constructor
+    BigInteger(BigInteger&& other) noexcept;  // Move constructor (steals limbs)
     
     // Assignment
     BigInteger& operator=(const BigInteger& other);
+    BigInteger& operator=(BigInteger&& other) noexcept;
     
     // Arithmetic operators (return new BigInteger)
     BigInteger operator+(const BigInteger& other) const;
@@ -61,9 +76,34 @@ public:
     // Python-style floor division (floors toward -∞)
     BigInteger floorDiv(const BigInteger& other) const;
     
+    // operands[0] +- operands[1] +- ... (subtract[i] negates operands[i]) in a
+    // single carry pass over all operands into one output buffer
+    static BigInteger sum(const std::vector<BigInteger>& operands, const std::vector<bool>& subtract);
+    
+    // In-place arithmetic (reuse this object's limb storage where possible)
+    BigInteger& operator+=(const BigInteger& other);
+    BigInteger& operator-=(const BigInteger& other);
+    BigInteger& operator*=(const BigInteger& other);
+    BigInteger& floorDivAssign(const BigInteger& other);  // this = this // other (Python semantics)
+    BigInteger& modAssign(const BigInteger& other);       // this = this %  other (Python semantics)
+    
+    // Scalar arithmetic: the other operand is a machine integer, so no
+    // temporary BigInteger is built and single-limb kernels do the work
+    BigInteger operator+(long long value) const;
+    BigInteger operator-(long long value) const;
+    BigInteger operator*(long long value) const;
+    BigInteger floorDiv(long long divisor) const;
+    long long operator%(long long divisor) const;         // Python modulo; always fits the divisor's range
+    BigInteger& operator+=(long long value);
+    BigInteger& operator-=(long long value);
+    BigInteger& operator*=(long long value);
+    BigInteger& floorDivAssign(long long divisor);
+    BigInteger& modAssign(long long divisor);
+    
     // Unary operators
     BigInteger operator-() const;  // Negation
     BigInteger operator+() const;  // Unary plus (returns copy)
+    BigInteger& negate();          // In-place negation
     
     // Comparison operators
     bool operator==(const BigInteger& other) const;
@@ -72,13 +112,40 @@ public:
     bool operator<=(const BigInteger& other) const;
     bool operator>(const BigInteger& other) const;
     bool operator>=(const BigInteger& other) const;
+    int compare(long long value) const;    // -1, 0, 1 against a machine integer
+    int compare(double value) const;       // Exact -1, 0, 1 against a float (value must not be NaN)
+    bool operator==(long long value) const;
+    bool operator!=(long long value) const;
     
     // Conversion methods
     std::string toString() const;          // Convert to decimal string
     long long toLongLong() const;          // Convert to long long (if fits)
+    double toDouble() const;               // Nearest double, ties to even (+-inf if out of range)
     bool isZero() const;                   // Check if value is zero
     bool isNegative() const;               // Check if value is negative
     bool fitsInInt() const;                // Check if value fits in int (32-bit signed)
+    size_t bitLength() const;              // Number of significant bits in |value| (0 for zero)
+    bool testBit(size_t index) const;      // Bit `index` of |value|
+    
+    // Power: this ** exponent (left-to-right exponentiation with a squaring kernel)
+    BigInteger pow(uint64_t exponent) const;
+    
+    // Number theory
+    // (base ** exponent) % modulus with Python semantics: the result takes the
+    // modulus' sign, a negative exponent uses the modular inverse of base
+    static BigInteger powMod(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus);
+    // (a * b) % modulus with Python semantics, without the double-width
+    // product when both factors are already reduced (cached Barrett reciprocal)
+    static BigInteger mulMod(const BigInteger& a, const BigInteger& b, const BigInteger& modulus);
+    // Greatest common divisor of |a| and |b| (Lehmer, finishing with binary GCD on one word)
+    static BigInteger gcd(const BigInteger& a, const BigInteger& b);
+    
+    // Threading: at most `count` threads (the caller included) work on one
+    // multiplication or toString, and only once operands pass a size threshold
+    // of thousands of limbs; 1 keeps everything on the calling thread. The
+    // default comes from the BIGINT_THREADS environment variable, else the
+    // hardware concurrency capped at 8
+    static void setMaxThreads(unsigned count);
     
     // I/O operators
     friend std::ostream& operator<<(std::ostream& os, const BigInteger& bi);
@@ -86,14 +153,18 @@ public:
 
 private:
     // Storage
-    static const int BASE = 1000000000;    // 10^9
-    static const int BASE_DIGITS = 9;      // Number of decimal digits per element
+    using Limb = uint64_t;                 // One base-2^64 digit
+    static const size_t INLINE_LIMBS = 4;  // Limbs stored without a heap allocation
+    static const int DECIMAL_CHUNK_DIGITS = 19;               // Decimal digits per conversion chunk
+    static const uint64_t DECIMAL_CHUNK = 10000000000000000000ULL;  // 10^19, largest power of 10 in a limb
+    
+    using LimbVector = SmallVector<Limb, INLINE_LIMBS>;
     
-    std::vector<int> digits;               // Digits in base 10^9 (least significant first)
+    LimbVector limbs;                      // Magnitude in base 2^64 (least significant first)
     bool negative;                         // Sign: true = negative, false = positive/zero
     
     // Internal helper methods
-    void removeLeadingZeros();             // Remove leading zero digits
+    void removeLeadingZeros();             // Remove leading zero limbs
     void normalize();                      // Normalize representation (remove zeros, fix sign)
     
     // Comparison helpers (ignoring sign)
@@ -102,11 +173,26 @@ private:
     // Arithmetic helpers (for implementation)
     BigInteger addAbs(const BigInteger& other) const;      // Add absolute values
     BigInteger subtractAbs(const BigInteger& other) const; // Subtract absolute values (this >= other)
+    void addAbsAssign(const BigInteger& other);            // |this| += |other|
+    void subtractAbsAssign(const BigInteger& other);       // |this| -= |other| (|this| >= |other|)
+    void reverseSubtractAbsAssign(const BigInteger& other);// |this| = |other| - |this| (|other| > |this|)
+    void addSignedAssign(const BigInteger& other, bool otherNegative);  // Shared body of += and -=
+    void addScalarAssign(uint64_t magnitude, bool scalarNegative);      // Shared body of scalar += and -=
+    uint64_t divideAbsScalarAssign(uint64_t divisor);      // |this| /= divisor, returns |this| % divisor
+    void floorDivScalarAssign(uint64_t magnitude, bool divisorNegative);  // Shared body of scalar and one-limb //=
+    void modScalarAssign(uint64_t magnitude, bool divisorNegative);       // Shared body of scalar and one-limb %=
     BigInteger multiplyAbs(const BigInteger& other) const; // Multiply absolute values
+    static void multiplyLimbs(const LimbVector& a, const LimbVector& b,
+                              LimbVector& out);     // out = a * b (out must not alias a or b)
     void divideAbs(const BigInteger& divisor, BigInteger& quotient, BigInteger& remainder) const;
+    BigInteger shiftedLimbs(size_t count) const;           // |this| * 2^(64 * count)
+    static BigInteger modInverse(const BigInteger& value, const BigInteger& modulus);  // value^-1 mod modulus
     
     // String conversion helpers
-    static bool isValidNumber(const std::string& str);  // Validate numeric string
+    static bool parseChunk(const char* p, int count, uint64_t& out);  // Parse up to 19 digits (SWAR)
+    static bool parseDecimal(const char* p, size_t len, LimbVector& out);  // Divide-and-conquer parse
+    static const BigInteger& decimalPower(int level);      // 10^(19 * 2^level), cached
+    void appendDecimal(std::string& out, int level, size_t width) const;  // Divide-and-conquer toString
 };
 
 #endif // PYTHON_INTERPRETER_BIGINTEGER_H
@@ -1,4 +1,5 @@
 #include "Evalvisitor.h"
+#include <cstring>
 
 bool TupleValue::operator==(const TupleValue& other) const {
     return elements == other.elements;
@@ -10,6 +11,39 @@ bool ListValue::operator==(const ListValue& other) const {
 // Forward declare for lexicographic comparison
 static int compareValues(const Value& a, const Value& b);
 
+// Infinity and NaN, told apart by their exponent bits: the build uses -Ofast,
+// whose -ffinite-math-only lets the compiler fold std::isinf and std::isnan to
+// false
+static bool isInfinite(double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return (bits & 0x7FFFFFFFFFFFFFFFULL) == 0x7FF0000000000000ULL;
+}
+
+static bool isNaN(double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return (bits & 0x7FFFFFFFFFFFFFFFULL) > 0x7FF0000000000000ULL;
+}
+
+// BigInteger -> float for int/float mixing (Python raises instead of producing inf)
+static double bigIntegerToFloat(const BigInteger& v) {
+    double d = v.toDouble();
+    if (isInfinite(d)) {
+        throw std::runtime_error("OverflowError: int too large to convert to float");
+    }
+    return d;
+}
+
+// float op BigInteger: the integer operand becomes a float, as in Python
+static void promoteBigIntegerToFloat(Value& a, Value& b) {
+    if (std::holds_alternative<double>(a) && std::holds_alternative<BigInteger>(b)) {
+        b = Value(bigIntegerToFloat(std::get<BigInteger>(b)));
+    } else if (std::holds_alternative<BigInteger>(a) && std::holds_alternative<double>(b)) {
+        a = Value(bigIntegerToFloat(std::get<BigInteger>(a)));
+    }
+}
+
 // Compare two values: returns -1 if a < b, 0 if a == b, 1 if a > b
 // Supports: int, bool, double, BigInteger, string, list, tuple
 static int compareValues(const Value& a, const Value& b) {
@@ -32,16 +66,20 @@ static int compareValues(const Value& a, const Value& b) {
             if (la < rb) return -1;
             if (rb < la) return 1;
             return 0;
+        } else if (aIsBig && !std::holds_alternative<double>(b)) {
+            // BigInteger vs int/bool: scalar compare
+            return std::get<BigInteger>(a).compare((long long)toDouble(b));
+        } else if (bIsBig && !std::holds_alternative<double>(a)) {
+            return -std::get<BigInteger>(b).compare((long long)toDouble(a));
         } else if (aIsBig) {
-            BigInteger rb((long long)toDouble(b));
-            if (std::get<BigInteger>(a) < rb) return -1;
-            if (rb < std::get<BigInteger>(a)) return 1;
-            return 0;
+            // BigInteger vs float: exact, no conversion of either side
+            double db = toDouble(b);
+            if (isNaN(db)) return 0;
+            return std::get<BigInteger>(a).compare(db);
         } else if (bIsBig) {
-            BigInteger la((long long)toDouble(a));
-            if (la < std::get<BigInteger>(b)) return -1;
-            if (std::get<BigInteger>(b) < la) return 1;
-            return 0;
+            double da = toDouble(a);
+            if (isNaN(da)) return 0;
+            return -std::get<BigInteger>(b).compare(da);
         } else {
             double da = toDouble(a), db = toDouble(b);
             if (da < db) return -1;
@@ -162,13 +200,19 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
                                 int s3 = static_cast<int>(lvl3.elements->size());
                                 if (idx3 < 0) idx3 = s3 + idx3;
                                 if (idx3 >= 0 && idx3 < s3) {
-                                    Value currentVal = (*lvl3.elements)[idx3];
+                                    Value before;
+                                    Value* target = augAssignTarget((*lvl3.elements)[idx3], testlists[1], before);
                                     auto rightAny = visit(testlists[1]);
                                     Value rightVal;
                                     if (rightAny.has_value()) {
                                         try { rightVal = std::any_cast<Value>(rightAny); } catch (...) { rightVal = Value(0); }
                                     } else { rightVal = Value(0); }
                                     std::string op = augassign->getText();
+                                    if (applyAugAssignInPlace(*target, op, rightVal)) {
+                                        if (target == &before) (*lvl3.elements)[idx3] = std::move(before);
+                                        return std::any();
+                                    }
+                                    Value currentVal = *target;
                                     if (std::holds_alternative<bool>(currentVal)) currentVal = Value(std::get<bool>(currentVal) ? 1 : 0);
                                     if (std::holds_alternative<bool>(rightVal)) rightVal = Value(std::get<bool>(rightVal) ? 1 : 0);
                                     Value newVal;
@@ -274,13 +318,19 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
                             }
                             if (idx2 < 0) idx2 += static_cast<int>(innerList.elements->size());
                             if (idx2 >= 0 && idx2 < static_cast<int>(innerList.elements->size())) {
-                                Value currentVal = (*innerList.elements)[idx2];
+                                Value before;
+                                Value* target = augAssignTarget((*innerList.elements)[idx2], testlists[1], before);
                                 auto rightAny = visit(testlists[1]);
                                 Value rightVal;
                                 if (rightAny.has_value()) {
                                     try { rightVal = std::any_cast<Value>(rightAny); } catch (...) { rightVal = Value(0); }
                                 } else { rightVal = Value(0); }
                                 std::string op = augassign->getText();
+                                if (applyAugAssignInPlace(*target, op, rightVal)) {
+                                    if (target == &before) (*innerList.elements)[idx2] = std::move(before);
+                                    return std::any();
+                                }
+                                Value currentVal = *target;
                                 if (std::holds_alternative<bool>(currentVal)) currentVal = Value(std::get<bool>(currentVal) ? 1 : 0);
                                 if (std::holds_alternative<bool>(rightVal)) rightVal = Value(std::get<bool>(rightVal) ? 1 : 0);
                                 Value newVal;
@@ -370,13 +420,19 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
                         }
                         if (idx < 0) idx += static_cast<int>(lst.elements->size());
                         if (idx >= 0 && idx < static_cast<int>(lst.elements->size())) {
-                            Value currentVal = (*lst.elements)[idx];
+                            Value before;
+                            Value* target = augAssignTarget((*lst.elements)[idx], testlists[1], before);
                             auto rightAny = visit(testlists[1]);
                             Value rightVal;
                             if (rightAny.has_value()) {
                                 try { rightVal = std::any_cast<Value>(rightAny); } catch (...) { rightVal = Value(0); }
                             } else { rightVal = Value(0); }
                             std::string op = augassign->getText();
+                            if (applyAugAssignInPlace(*target, op, rightVal)) {
+                                if (target == &before) (*lst.elements)[idx] = std::move(before);
+                                return std::any();
+                            }
+                            Value currentVal = *target;
                             if (std::holds_alternative<bool>(currentVal)) currentVal = Value(std::get<bool>(currentVal) ? 1 : 0);
                             if (std::holds_alternative<bool>(rightVal)) rightVal = Value(std::get<bool>(rightVal) ? 1 : 0);
                             Value newVal;
@@ -476,10 +532,10 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
                             } else if (op == "/=") {
                                 double l = std::holds_alternative<double>(currentVal) ? std::get<double>(currentVal) :
                                            (std::holds_alternative<int>(currentVal) ? static_cast<double>(std::get<int>(currentVal)) :
-                                           (std::holds_alternative<BigInteger>(currentVal) ? std::stod(std::get<BigInteger>(currentVal).toString()) : 0.0));
+                                           (std::holds_alternative<BigInteger>(currentVal) ? bigIntegerToFloat(std::get<BigInteger>(currentVal)) : 0.0));
                                 double r = std::holds_alternative<double>(rightVal) ? std::get<double>(rightVal) :
                                            (std::holds_alternative<int>(rightVal) ? static_cast<double>(std::get<int>(rightVal)) :
-                                           (std::holds_alternative<BigInteger>(rightVal) ? std::stod(std::get<BigInteger>(rightVal).toString()) : 1.0));
+                                           (std::holds_alternative<BigInteger>(rightVal) ? bigIntegerToFloat(std::get<BigInteger>(rightVal)) : 1.0));
                                 if (r != 0.0) newVal = l / r;
                                 else newVal = currentVal;  // Division by zero protection
                             } else if (op == "**=") {
@@ -505,16 +561,14 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
             bool isLocal = !isGlobal && (currentFunctionLocals != nullptr && 
                            currentFunctionLocals->find(varName) != currentFunctionLocals->end());
             
-            // Get the current value of the variable
-            Value currentValue;
-            bool found = false;
+            // Locate the variable's storage slot; the operation is applied to it directly
+            Value* slot = nullptr;
             
             if (isGlobal) {
                 // Declared global: ALWAYS read from global scope (skip localVariables entirely)
                 auto it = variables.find(varName);
                 if (it != variables.end()) {
-                    currentValue = it->second;
-                    found = true;
+                    slot = &it->second;
                 }
             } else if (isLocal) {
                 // This is a local variable - only look in local scope (no global fallback)
@@ -523,8 +577,7 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
                 if (localVariables != nullptr) {
                     auto localIt = localVariables->find(varName);
                     if (localIt != localVariables->end()) {
-                        currentValue = localIt->second;
-                        found = true;
+                        slot = &localIt->second;
                     }
                 }
                 // DO NOT fall back to global when isLocal=true
@@ -534,30 +587,29 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
                 if (localVariables != nullptr) {
                     auto localIt = localVariables->find(varName);
                     if (localIt != localVariables->end()) {
-                        currentValue = localIt->second;
-                        found = true;
+                        slot = &localIt->second;
                     }
                 }
                 // Then check global
-                if (!found) {
+                if (!slot) {
                     auto it = variables.find(varName);
                     if (it != variables.end()) {
-                        currentValue = it->second;
-                        found = true;
+                        slot = &it->second;
                     }
                 }
             }
             
-            if (!found) {
+            if (!slot) {
                 if (isLocal) {
                     // UnboundLocalError: local variable referenced before assignment
                     // This matches Python's standard behavior for augmented assignment
                     throw std::runtime_error("UnboundLocalError: local variable '" + varName + "' referenced before assignment");
                 }
                 // Non-local: initialize to 0 in global scope
-                currentValue = Value(0);
-                variables[varName] = Value(0);
+                slot = &(variables[varName] = Value(0));
             }
+            Value before;
+            Value* target = augAssignTarget(*slot, testlists[1], before);
             
             // Evaluate the right-hand side
             auto rightAny = visit(testlists[1]);
@@ -575,6 +627,28 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
             // Get the operator
             std::string op = augassign->getText();
             
+            // `x *= y` followed by `x %= m`: store the reduced product right away,
+            // so the `%=` only has to check an operand that is already below m
+            if (op == "*=" && !mulAssignModuli.empty()) {
+                Value literal;
+                const Value* modulus = findFollowingModulus(ctx, literal);
+                auto isInteger = [](const Value& v) {
+                    return std::holds_alternative<int>(v) || std::holds_alternative<BigInteger>(v);
+                };
+                if (modulus && isInteger(*target) && isInteger(rightValue) && isInteger(*modulus) &&
+                    !(std::holds_alternative<int>(*modulus) && std::get<int>(*modulus) == 0)) {
+                    *slot = mulModValue(*target, rightValue, *modulus);
+                    return std::any();
+                }
+            }
+            
+            // BigInteger arithmetic and string concatenation mutate the slot directly
+            if (applyAugAssignInPlace(*target, op, rightValue)) {
+                if (target == &before) *slot = std::move(before);
+                return std::any();
+            }
+            Value currentValue = *target;
+            
             // Promote bool to int for augmented arithmetic (Python: bool IS-A int)
             if (std::holds_alternative<bool>(currentValue)) {
                 currentValue = Value(std::get<bool>(currentValue) ? 1 : 0);
@@ -582,6 +656,9 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
             if (std::holds_alternative<bool>(rightValue)) {
                 rightValue = Value(std::get<bool>(rightValue) ? 1 : 0);
             }
+            if (op != "**=") {
+                promoteBigIntegerToFloat(currentValue, rightValue);
+            }
             
             // Apply the operation
             Value result;
@@ -697,9 +774,12 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
                 }
             } else if (op == "/=") {
                 // Division always returns double
-                double left = std::holds_alternative<double>(currentValue) ? std::get<double>(currentValue) : static_cast<double>(std::get<int>(currentValue));
-                double right = std::holds_alternative<double>(rightValue) ? std::get<double>(rightValue) : static_cast<double>(std::get<int>(rightValue));
-                result = left / right;
+                auto toFloat = [](const Value& v) -> double {
+                    if (std::holds_alternative<double>(v)) return std::get<double>(v);
+                    if (std::holds_alternative<BigInteger>(v)) return bigIntegerToFloat(std::get<BigInteger>(v));
+                    return static_cast<double>(std::get<int>(v));
+                };
+                result = toFloat(currentValue) / toFloat(rightValue);
             } else if (op == "//=") {
                 // Floor division
                 if (std::holds_alternative<BigInteger>(currentValue) || std::holds_alternative<BigInteger>(rightValue)) {
@@ -756,28 +836,9 @@ std::any EvalVisitor::visitExpr_stmt(Python3Parser::Expr_stmtContext *ctx) {
                 result = powerValue(currentValue, rightValue);
             }
             
-            // Store the result (in local scope if local variable, otherwise global)
-            if (isGlobal) {
-                // Declared global: ALWAYS write to global scope only
-                // Never write to localVariables to avoid stale-read bugs on subsequent augmented assigns
-                variables[varName] = result;
-            } else if (isLocal && localVariables != nullptr) {
-                // This is a local variable (assigned via = in this function scope)
-                // Only write to local scope - do NOT write back to global (even if same name exists there)
-                (*localVariables)[varName] = result;
-            } else if (!isLocal && localVariables != nullptr) {
-                // It's a parameter or global being modified
-                auto localIt = localVariables->find(varName);
-                if (localIt != localVariables->end()) {
-                    // Modify the parameter (local copy)
-                    (*localVariables)[varName] = result;
-                } else {
-                    // Modify global (not a parameter, not explicitly local)
-                    variables[varName] = result;
-                }
-            } else {
-                variables[varName] = result;
-            }
+            // Store the result back into the slot it was read from (the scope rules
+            // above already picked local, parameter or global storage)
+            *slot = result;
         }
         
         return std::any();
@@ -1311,7 +1372,7 @@ std::any EvalVisitor::visitAtom_expr(Python3Parser::Atom_exprContext *ctx) {
                 if (funcIt2 == functions.end()) {
                     // Check if calleeName is a built-in — dispatch if so
                     static const std::set<std::string> builtinNames2 = {
-                        "abs", "len", "str", "int", "float", "bool", "print"
+                        "abs", "len", "str", "int", "float", "bool", "print", "pow", "gcd"
                     };
                     if (builtinNames2.count(calleeName)) {
                         // Evaluate first positional arg and call the built-in
@@ -1328,7 +1389,11 @@ std::any EvalVisitor::visitAtom_expr(Python3Parser::Atom_exprContext *ctx) {
                                 }
                             }
                         }
-                        if (!builtinArgs.empty() && calleeName != "print") {
+                        if (calleeName == "pow") {
+                            currentValue = builtinPow(builtinArgs);
+                        } else if (calleeName == "gcd") {
+                            currentValue = builtinGcd(builtinArgs);
+                        } else if (!builtinArgs.empty() && calleeName != "print") {
                             currentValue = callBuiltinSingle(calleeName, builtinArgs[0]);
                         } else if (calleeName == "print") {
                             for (size_t pi = 0; pi < builtinArgs.size(); pi++) {
@@ -1561,10 +1626,11 @@ std::any EvalVisitor::visitAtom_expr(Python3Parser::Atom_exprContext *ctx) {
                                     intResult = Value(std::get<bool>(val) ? 1 : 0);
                                 } else if (std::holds_alternative<std::string>(val)) {
                                     // str → int: parse string as integer
-                                    std::string str = std::get<std::string>(val);
+                                    const std::string& str = std::get<std::string>(val);
                                     // Check if it's a large number that needs BigInteger
                                     bool negative = !str.empty() && str[0] == '-';
-                                    std::string absStr = negative ? str.substr(1) : str;
+                                    std::string_view absStr(str);
+                                    if (negative) absStr.remove_prefix(1);
                                     if (absStr.length() > 10 || 
                                         (absStr.length() == 10 && absStr > "2147483647")) {
                                         intResult = Value(BigInteger(str));
@@ -1613,13 +1679,7 @@ std::any EvalVisitor::visitAtom_expr(Python3Parser::Atom_exprContext *ctx) {
                                     std::string str = std::get<std::string>(val);
                                     floatResult = Value(std::stod(str));
                                 } else if (std::holds_alternative<BigInteger>(val)) {
-                                    BigInteger bi = std::get<BigInteger>(val);
-                                    try {
-                                        long long ll = bi.toLongLong();
-                                        floatResult = Value(static_cast<double>(ll));
-                                    } catch (...) {
-                                        floatResult = Value(std::stod(bi.toString()));
-                                    }
+                                    floatResult = Value(bigIntegerToFloat(std::get<BigInteger>(val)));
                                 }
                             } catch (...) {
                                 // Error in conversion
@@ -1795,6 +1855,52 @@ std::any EvalVisitor::visitAtom_expr(Python3Parser::Atom_exprContext *ctx) {
             continue;
         }
 
+        // Handle pow() built-in: pow(b, e) behaves like b ** e, pow(b, e, m) runs
+        // native modular exponentiation (a user-defined pow() takes precedence)
+        if (funcName == "pow" && functions.find(funcName) == functions.end()) {
+            std::vector<Value> powArgs;
+            auto arglist = trailer->arglist();
+            if (arglist) {
+                for (auto arg : arglist->argument()) {
+                    auto tests = arg->test();
+                    if (tests.size() == 1) {
+                        auto argValue = visit(tests[0]);
+                        Value val = Value(std::monostate{});
+                        if (argValue.has_value()) {
+                            try { val = std::any_cast<Value>(argValue); } catch (...) {}
+                        }
+                        powArgs.push_back(val);
+                    }
+                }
+            }
+            currentValue = builtinPow(powArgs);
+            isFirstTrailer = false;
+            continue;
+        }
+
+        // Handle gcd() built-in: native Lehmer GCD over any number of integer
+        // arguments (a user-defined gcd() takes precedence)
+        if (funcName == "gcd" && functions.find(funcName) == functions.end()) {
+            std::vector<Value> gcdArgs;
+            auto arglist = trailer->arglist();
+            if (arglist) {
+                for (auto arg : arglist->argument()) {
+                    auto tests = arg->test();
+                    if (tests.size() == 1) {
+                        auto argValue = visit(tests[0]);
+                        Value val = Value(std::monostate{});
+                        if (argValue.has_value()) {
+                            try { val = std::any_cast<Value>(argValue); } catch (...) {}
+                        }
+                        gcdArgs.push_back(val);
+                    }
+                }
+            }
+            currentValue = builtinGcd(gcdArgs);
+            isFirstTrailer = false;
+            continue;
+        }
+
         // Handle max() built-in function — returns the maximum of 1+ arguments
         if (funcName == "max") {
             auto arglist = trailer->arglist();
@@ -2242,7 +2348,7 @@ std::any EvalVisitor::visitAtom_expr(Python3Parser::Atom_exprContext *ctx) {
                 {
                     static const std::set<std::string> builtinFuncNames = {
                         "abs", "len", "str", "int", "float", "bool", "print",
-                        "sorted", "max", "min"
+                        "sorted", "max", "min", "pow", "gcd"
                     };
                     if (builtinFuncNames.count(funcName)) {
                         // Evaluate positional args and dispatch to built-in
@@ -2273,6 +2379,11 @@ std::any EvalVisitor::visitAtom_expr(Python3Parser::Atom_exprContext *ctx) {
                             isFirstTrailer = false;
                             continue;
                         }
+                        if (funcName == "pow" || funcName == "gcd") {
+                            currentValue = funcName == "pow" ? builtinPow(positionalArgs) : builtinGcd(positionalArgs);
+                            isFirstTrailer = false;
+                            continue;
+                        }
                         // For other built-ins (print, max, min, sorted), the dispatch is complex.
                         // Fall through to let the built-in names be picked up as no-op for now.
                         // print: just print the args separated by spaces
@@ -2511,7 +2622,8 @@ std::any EvalVisitor::visitAtom(Python3Parser::AtomContext *ctx) {
             // int can hold roughly -2B to +2B, which is 10 digits for positive
             // If the number is too large, use BigInteger
             bool negative = !numStr.empty() && numStr[0] == '-';
-            std::string absNumStr = negative ? numStr.substr(1) : numStr;
+            std::string_view absNumStr(numStr);
+            if (negative) absNumStr.remove_prefix(1);
             
             // Check if number is too large for int (more than 10 digits, or exactly 10 and >= 2147483648)
             if (absNumStr.length() > 10 || 
@@ -2545,51 +2657,14 @@ std::any EvalVisitor::visitAtom(Python3Parser::AtomContext *ctx) {
     auto name = ctx->NAME();
     if (name) {
         std::string varName = name->getText();
-        // Check if declared global
+        if (const Value* stored = findVariable(varName)) {
+            return *stored;
+        }
+        // A local that is not bound yet never resolves to a function of the same name
         bool isGlobal = (currentFunctionGlobals.find(varName) != currentFunctionGlobals.end());
-        
-        // If we're in a function and this variable is local (and NOT global), look in local scope
         if (!isGlobal && currentFunctionLocals != nullptr && currentFunctionLocals->find(varName) != currentFunctionLocals->end()) {
-            // This is a local variable - must look in local scope only
-            if (localVariables != nullptr) {
-                auto localIt = localVariables->find(varName);
-                if (localIt != localVariables->end()) {
-                    return localIt->second;
-                }
-            }
-            // Check enclosing scope (for nested functions)
-            if (enclosingLocalVariables != nullptr) {
-                auto encIt = enclosingLocalVariables->find(varName);
-                if (encIt != enclosingLocalVariables->end()) {
-                    return encIt->second;
-                }
-            }
-            // Local variable not initialized - fall back to global scope per spec:
-            // "global variables are effective in all scopes (can be accessed without the global keyword)"
-            auto globalIt = variables.find(varName);
-            if (globalIt != variables.end()) {
-                return globalIt->second;
-            }
             return Value(std::monostate{});  // Variable not found anywhere
         }
-        // Otherwise, check global variables (includes parameters which are in local scope but not in assignedVars, and globals)
-        if (!isGlobal && localVariables != nullptr) {
-            auto localIt = localVariables->find(varName);
-            if (localIt != localVariables->end()) {
-                return localIt->second;
-            }
-        }
-        // Check enclosing scope (for nested functions)
-        if (enclosingLocalVariables != nullptr) {
-            auto encIt = enclosingLocalVariables->find(varName);
-            if (encIt != enclosingLocalVariables->end()) {
-                return encIt->second;
-            }
-        }
-        auto it = variables.find(varName);
-        if (it != variables.end()) {
-            return it->second;
-        }
         // Variable not found in variables — check if it's a function name
         if (functions.find(varName) != functions.end()) {
             return Value(FunctionValue(varName));
@@ -2597,7 +2672,7 @@ std::any EvalVisitor::visitAtom(Python3Parser::AtomContext *ctx) {
         // Check if it's a built-in function name — return as first-class value
         static const std::set<std::string> builtinNames = {
             "abs", "len", "str", "int", "float", "bool",
-            "sorted", "max", "min", "print"
+            "sorted", "max", "min", "print", "pow", "gcd"
         };
         if (builtinNames.count(varName)) {
             return Value(FunctionValue(varName));
@@ -2751,6 +2826,12 @@ std::any EvalVisitor::visitFormat_string(Python3Parser::Format_stringContext *ct
 
 std::any EvalVisitor::visitArith_expr(Python3Parser::Arith_exprContext *ctx) {
     // arith_expr: term (addorsub_op term)*
+    if (ctx->children.size() > 1 && !foldedConstants.empty()) {
+        auto folded = foldedConstants.find(ctx);
+        if (folded != foldedConstants.end()) {
+            return folded->second;
+        }
+    }
     auto terms = ctx->term();
     if (terms.empty()) {
         return std::any();
@@ -2771,6 +2852,24 @@ std::any EvalVisitor::visitArith_expr(Python3Parser::Arith_exprContext *ctx) {
     
     // Process remaining terms with operators
     auto ops = ctx->addorsub_op();
+    
+    // With three or more terms, a run of int/BigInteger terms that involves a
+    // BigInteger is collected here and added up by one BigInteger::sum call,
+    // instead of allocating and downcasting a temporary per operator
+    std::vector<BigInteger> chain;
+    std::vector<bool> chainSubtract;
+    auto isInteger = [](const Value& v) {
+        return std::holds_alternative<int>(v) || std::holds_alternative<BigInteger>(v);
+    };
+    auto takeBigInteger = [](Value& v) {
+        return std::holds_alternative<BigInteger>(v) ? std::move(std::get<BigInteger>(v)) : BigInteger(std::get<int>(v));
+    };
+    auto flushChain = [&]() {
+        result = tryDowncastBigInteger(BigInteger::sum(chain, chainSubtract));
+        chain.clear();
+        chainSubtract.clear();
+    };
+    
     for (size_t i = 0; i < ops.size(); i++) {
         auto termValue = visit(terms[i + 1]);
         if (!termValue.has_value()) {
@@ -2794,9 +2893,50 @@ std::any EvalVisitor::visitArith_expr(Python3Parser::Arith_exprContext *ctx) {
             term = Value(std::get<bool>(term) ? 1 : 0);
         }
         
+        if (ops.size() >= 2 && isInteger(term)) {
+            if (chain.empty() && isInteger(result) &&
+                (std::holds_alternative<BigInteger>(result) || std::holds_alternative<BigInteger>(term))) {
+                chain.reserve(ops.size() + 1);
+                chain.push_back(takeBigInteger(result));
+                chainSubtract.push_back(false);
+            }
+            if (!chain.empty()) {
+                chain.push_back(takeBigInteger(term));
+                chainSubtract.push_back(op == "-");
+                continue;
+            }
+        }
+        if (!chain.empty()) {
+            // A non-integer term ends the run; integer addition is exact, so
+            // summing the run first gives the same value as left to right
+            flushChain();
+        }
+        promoteBigIntegerToFloat(result, term);
+        
         // Type coercion and operation
         // BigInteger has highest priority, then double, then int
-        if (std::holds_alternative<BigInteger>(result) || std::holds_alternative<BigInteger>(term)) {
+        if (std::holds_alternative<BigInteger>(result) && std::holds_alternative<int>(term)) {
+            // BigInteger op int: scalar kernel on our own copy, no promotion
+            BigInteger& left = std::get<BigInteger>(result);
+            int right = std::get<int>(term);
+            if (op == "+") {
+                left += right;
+            } else if (op == "-") {
+                left -= right;
+            }
+            result = tryDowncastBigInteger(std::move(left));
+        } else if (std::holds_alternative<int>(result) && std::holds_alternative<BigInteger>(term)) {
+            // int op BigInteger: a - b == -(b - a)
+            int left = std::get<int>(result);
+            BigInteger& right = std::get<BigInteger>(term);
+            if (op == "+") {
+                right += left;
+            } else if (op == "-") {
+                right -= left;
+                right.negate();
+            }
+            result = tryDowncastBigInteger(std::move(right));
+        } else if (std::holds_alternative<BigInteger>(result) || std::holds_alternative<BigInteger>(term)) {
             // Promote to BigInteger if needed
             BigInteger left = std::holds_alternative<BigInteger>(result) ? 
                 std::get<BigInteger>(result) : 
@@ -2863,17 +3003,43 @@ std::any EvalVisitor::visitArith_expr(Python3Parser::Arith_exprContext *ctx) {
             }
         }
     }
+    if (!chain.empty()) {
+        flushChain();
+    }
     
     return result;
 }
 
 std::any EvalVisitor::visitTerm(Python3Parser::TermContext *ctx) {
     // term: factor (muldivmod_op factor)*
+    if (ctx->children.size() > 1 && !foldedConstants.empty()) {
+        auto folded = foldedConstants.find(ctx);
+        if (folded != foldedConstants.end()) {
+            return folded->second;
+        }
+    }
     auto factors = ctx->factor();
     if (factors.empty()) {
         return std::any();
     }
     
+    // `name % k` on a stored BigInteger with a plain int divisor: read the limbs
+    // in place instead of copying the whole number out of the variable first
+    if (factors.size() == 2 && ctx->muldivmod_op(0)->getText() == "%") {
+        const Value* stored = peekBareName(factors[0]);
+        if (stored && std::holds_alternative<BigInteger>(*stored) &&
+            (peekBareName(factors[1]) || factors[1]->getText().find_first_not_of("0123456789") == std::string::npos)) {
+            // The divisor is a name or literal, so evaluating it cannot disturb *stored
+            auto divisorAny = visit(factors[1]);
+            if (divisorAny.has_value()) {
+                const Value& divisor = std::any_cast<const Value&>(divisorAny);
+                if (std::holds_alternative<int>(divisor)) {
+                    return Value(static_cast<int>(std::get<BigInteger>(*stored) % std::get<int>(divisor)));
+                }
+            }
+        }
+    }
+    
     // Visit the first factor
     auto resultAny = visit(factors[0]);
     if (!resultAny.has_value()) {
@@ -2911,6 +3077,29 @@ std::any EvalVisitor::visitTerm(Python3Parser::TermContext *ctx) {
         if (std::holds_alternative<bool>(factor)) {
             factor = Value(std::get<bool>(factor) ? 1 : 0);
         }
+        promoteBigIntegerToFloat(result, factor);
+        if (folding && op == "//" && std::holds_alternative<int>(factor) && std::get<int>(factor) == 0) {
+            return rejectFold();
+        }
+        
+        // `a * b % m` on integers: one fused modular multiply instead of building
+        // the full product. m is re-read if this bails out, so it must be a name
+        // or literal
+        if (op == "*" && i + 1 < ops.size() && ops[i + 1]->getText() == "%" &&
+            (std::holds_alternative<int>(result) || std::holds_alternative<BigInteger>(result)) &&
+            (std::holds_alternative<int>(factor) || std::holds_alternative<BigInteger>(factor)) &&
+            (peekBareName(factors[i + 2]) || factors[i + 2]->getText().find_first_not_of("0123456789") == std::string::npos)) {
+            auto modulusAny = visit(factors[i + 2]);
+            if (modulusAny.has_value()) {
+                const Value& modulus = std::any_cast<const Value&>(modulusAny);
+                if ((std::holds_alternative<int>(modulus) && std::get<int>(modulus) != 0) ||
+                    std::holds_alternative<BigInteger>(modulus)) {
+                    result = mulModValue(result, factor, modulus);
+                    i++;
+                    continue;
+                }
+            }
+        }
         
         // Type coercion and operation
         // Handle string multiplication: string * int or int * string
@@ -2933,6 +3122,9 @@ std::any EvalVisitor::visitTerm(Python3Parser::TermContext *ctx) {
             if (count <= 0) {
                 result = std::string("");
             } else {
+                if (folding && s.size() * count > FOLD_LIMIT) {
+                    return rejectFold();
+                }
                 std::string repeated;
                 // Pre-allocate memory to avoid O(n²) behavior
                 repeated.reserve(s.size() * count);
@@ -2982,6 +3174,26 @@ std::any EvalVisitor::visitTerm(Python3Parser::TermContext *ctx) {
                 }
             }
             result = TupleValue(newElems);
+        } else if (std::holds_alternative<BigInteger>(result) && std::holds_alternative<int>(factor) && op != "/") {
+            // BigInteger op int: single-limb multiply/divide, no promotion
+            BigInteger& left = std::get<BigInteger>(result);
+            int right = std::get<int>(factor);
+            if (op == "%") {
+                // |result| < |right|, so it is always an int
+                result = Value(static_cast<int>(left % right));
+            } else {
+                if (op == "*") {
+                    left *= right;
+                } else if (op == "//") {
+                    left.floorDivAssign(right);
+                }
+                result = tryDowncastBigInteger(std::move(left));
+            }
+        } else if (std::holds_alternative<int>(result) && std::holds_alternative<BigInteger>(factor) && op == "*") {
+            // int * BigInteger
+            BigInteger& right = std::get<BigInteger>(factor);
+            right *= std::get<int>(result);
+            result = tryDowncastBigInteger(std::move(right));
         } else if (std::holds_alternative<BigInteger>(result) || std::holds_alternative<BigInteger>(factor)) {
             // Handle BigInteger operations
             // Promote to BigInteger if needed
@@ -2999,10 +3211,7 @@ std::any EvalVisitor::visitTerm(Python3Parser::TermContext *ctx) {
                 result = tryDowncastBigInteger(left % right);
             } else if (op == "/") {
                 // BigInteger division returns double
-                // Convert to string and then to double for precision
-                double leftD = std::stod(left.toString());
-                double rightD = std::stod(right.toString());
-                result = leftD / rightD;
+                result = bigIntegerToFloat(left) / bigIntegerToFloat(right);
             }
         } else if (op == "/") {
             // Division always returns double
@@ -3059,6 +3268,12 @@ std::any EvalVisitor::visitTerm(Python3Parser::TermContext *ctx) {
 
 std::any EvalVisitor::visitFactor(Python3Parser::FactorContext *ctx) {
     // factor: ('+'|'-') factor | power
+    if (ctx->children.size() > 1 && !foldedConstants.empty()) {
+        auto folded = foldedConstants.find(ctx);
+        if (folded != foldedConstants.end()) {
+            return folded->second;
+        }
+    }
     
     // Check if there's a unary operator
     auto text = ctx->getText();
@@ -3119,6 +3334,12 @@ std::any EvalVisitor::visitFactor(Python3Parser::FactorContext *ctx) {
 
 std::any EvalVisitor::visitPower(Python3Parser::PowerContext *ctx) {
     // power: atom_expr (POWER factor)?
+    if (ctx->children.size() > 1 && !foldedConstants.empty()) {
+        auto folded = foldedConstants.find(ctx);
+        if (folded != foldedConstants.end()) {
+            return folded->second;
+        }
+    }
     auto atomExpr = ctx->atom_expr();
     if (!atomExpr) {
         return std::any();
@@ -3190,8 +3411,40 @@ std::any EvalVisitor::visitComparison(Python3Parser::ComparisonContext *ctx) {
         bool compResult = false;
         
         // Perform comparison based on types
-        // Handle BigInteger comparisons
-        if (std::holds_alternative<BigInteger>(left) || std::holds_alternative<BigInteger>(right)) {
+        // BigInteger vs int/bool: scalar compare, no promotion
+        if ((std::holds_alternative<BigInteger>(left) &&
+             (std::holds_alternative<int>(right) || std::holds_alternative<bool>(right))) ||
+            (std::holds_alternative<BigInteger>(right) &&
+             (std::holds_alternative<int>(left) || std::holds_alternative<bool>(left)))) {
+            bool bigOnLeft = std::holds_alternative<BigInteger>(left);
+            const Value& scalar = bigOnLeft ? right : left;
+            long long s = std::holds_alternative<int>(scalar) ? std::get<int>(scalar) : (std::get<bool>(scalar) ? 1 : 0);
+            int c = std::get<BigInteger>(bigOnLeft ? left : right).compare(s);
+            if (!bigOnLeft) c = -c;
+            if (op == "<") compResult = c < 0;
+            else if (op == ">") compResult = c > 0;
+            else if (op == "<=") compResult = c <= 0;
+            else if (op == ">=") compResult = c >= 0;
+            else if (op == "==") compResult = c == 0;
+            else if (op == "!=") compResult = c != 0;
+        } else if ((std::holds_alternative<BigInteger>(left) && std::holds_alternative<double>(right)) ||
+                   (std::holds_alternative<BigInteger>(right) && std::holds_alternative<double>(left))) {
+            // BigInteger vs float: exact comparison; NaN is unordered
+            bool bigOnLeft = std::holds_alternative<BigInteger>(left);
+            double d = std::get<double>(bigOnLeft ? right : left);
+            if (isNaN(d)) {
+                compResult = op == "!=";
+            } else {
+                int c = std::get<BigInteger>(bigOnLeft ? left : right).compare(d);
+                if (!bigOnLeft) c = -c;
+                if (op == "<") compResult = c < 0;
+                else if (op == ">") compResult = c > 0;
+                else if (op == "<=") compResult = c <= 0;
+                else if (op == ">=") compResult = c >= 0;
+                else if (op == "==") compResult = c == 0;
+                else if (op == "!=") compResult = c != 0;
+            }
+        } else if (std::holds_alternative<BigInteger>(left) || std::holds_alternative<BigInteger>(right)) {
             // Promote to BigInteger if needed
             BigInteger l = std::holds_alternative<BigInteger>(left) ? 
                 std::get<BigInteger>(left) : 
@@ -3407,8 +3660,8 @@ std::string EvalVisitor::floatToRepr(double d) {
     // Examples: 1.0 → "1.0", 3.14 → "3.14", 0.1 → "0.1", 100.0 → "100.0"
     
     // Handle special cases
-    if (std::isinf(d)) return d > 0 ? "inf" : "-inf";
-    if (std::isnan(d)) return "nan";
+    if (isInfinite(d)) return d > 0 ? "inf" : "-inf";
+    if (isNaN(d)) return "nan";
     
     // Try increasing precision to find shortest roundtrip
     for (int prec = 1; prec <= 17; prec++) {
@@ -3469,6 +3722,72 @@ std::string EvalVisitor::floatToRepr(double d) {
     return s;
 }
 
+const Value* EvalVisitor::findVariable(const std::string& varName) {
+    // Check if declared global
+    bool isGlobal = (currentFunctionGlobals.find(varName) != currentFunctionGlobals.end());
+    
+    // If we're in a function and this variable is local (and NOT global), look in local scope
+    if (!isGlobal && currentFunctionLocals != nullptr && currentFunctionLocals->find(varName) != currentFunctionLocals->end()) {
+        // This is a local variable - must look in local scope only
+        if (localVariables != nullptr) {
+            auto localIt = localVariables->find(varName);
+            if (localIt != localVariables->end()) {
+                return &localIt->second;
+            }
+        }
+        // Check enclosing scope (for nested functions)
+        if (enclosingLocalVariables != nullptr) {
+            auto encIt = enclosingLocalVariables->find(varName);
+            if (encIt != enclosingLocalVariables->end()) {
+                return &encIt->second;
+            }
+        }
+        // Local variable not initialized - fall back to global scope per spec:
+        // "global variables are effective in all scopes (can be accessed without the global keyword)"
+        auto globalIt = variables.find(varName);
+        if (globalIt != variables.end()) {
+            return &globalIt->second;
+        }
+        return nullptr;
+    }
+    // Otherwise, check global variables (includes parameters which are in local scope but not in assignedVars, and globals)
+    if (!isGlobal && localVariables != nullptr) {
+        auto localIt = localVariables->find(varName);
+        if (localIt != localVariables->end()) {
+            return &localIt->second;
+        }
+    }
+    // Check enclosing scope (for nested functions)
+    if (enclosingLocalVariables != nullptr) {
+        auto encIt = enclosingLocalVariables->find(varName);
+        if (encIt != enclosingLocalVariables->end()) {
+            return &encIt->second;
+        }
+    }
+    auto it = variables.find(varName);
+    if (it != variables.end()) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+const Value* EvalVisitor::peekBareName(Python3Parser::FactorContext* factor) {
+    // factor -> power -> atom_expr -> atom NAME, with no sign, exponent or trailers
+    auto power = factor->power();
+    if (!power || power->factor()) {
+        return nullptr;
+    }
+    auto atomExpr = power->atom_expr();
+    if (!atomExpr || !atomExpr->trailer().empty()) {
+        return nullptr;
+    }
+    auto name = atomExpr->atom()->NAME();
+    if (!name) {
+        return nullptr;
+    }
+    return findVariable(name->getText());
+}
+
 Value EvalVisitor::tryDowncastBigInteger(const BigInteger& bi) {
     // If the BigInteger fits in a regular int, downcast it for performance
     if (bi.fitsInInt()) {
@@ -3477,6 +3796,76 @@ Value EvalVisitor::tryDowncastBigInteger(const BigInteger& bi) {
     return Value(bi);
 }
 
+Value EvalVisitor::tryDowncastBigInteger(BigInteger&& bi) {
+    if (bi.fitsInInt()) {
+        return Value(static_cast<int>(bi.toLongLong()));
+    }
+    return Value(std::move(bi));
+}
+
+Value* EvalVisitor::augAssignTarget(Value& slot, antlr4::tree::ParseTree* right, Value& before) {
+    if (!containsCall(right)) {
+        return &slot;
+    }
+    before = slot;
+    return &before;
+}
+
+bool EvalVisitor::containsCall(antlr4::tree::ParseTree* node) {
+    if (node->getTreeType() != antlr4::tree::ParseTreeType::RULE) {
+        return false;
+    }
+    auto ctx = static_cast<antlr4::ParserRuleContext*>(node);
+    if (ctx->getRuleIndex() == Python3Parser::RuleTrailer &&
+        static_cast<Python3Parser::TrailerContext*>(ctx)->OPEN_PAREN()) {
+        return true;
+    }
+    for (auto child : ctx->children) {
+        if (containsCall(child)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EvalVisitor::applyAugAssignInPlace(Value& target, const std::string& op, const Value& right) {
+    if (std::holds_alternative<BigInteger>(target)) {
+        // BigInteger op= int/BigInteger: update the stored limbs instead of building a new value
+        BigInteger& acc = std::get<BigInteger>(target);
+        if (std::holds_alternative<BigInteger>(right)) {
+            const BigInteger& rhs = std::get<BigInteger>(right);
+            if (op == "+=") acc += rhs;
+            else if (op == "-=") acc -= rhs;
+            else if (op == "*=") acc *= rhs;
+            else if (op == "//=") acc.floorDivAssign(rhs);
+            else if (op == "%=") acc.modAssign(rhs);
+            else return false;
+        } else if (std::holds_alternative<int>(right) || std::holds_alternative<bool>(right)) {
+            // Machine-int operand: scalar kernels, no promotion
+            long long rhs = std::holds_alternative<int>(right) ? std::get<int>(right) : (std::get<bool>(right) ? 1 : 0);
+            if (op == "+=") acc += rhs;
+            else if (op == "-=") acc -= rhs;
+            else if (op == "*=") acc *= rhs;
+            else if (op == "//=") acc.floorDivAssign(rhs);
+            else if (op == "%=") acc.modAssign(rhs);
+            else return false;
+        } else {
+            return false;
+        }
+        
+        // Same downcast rule as tryDowncastBigInteger
+        if (acc.fitsInInt()) {
+            target = Value(static_cast<int>(acc.toLongLong()));
+        }
+        return true;
+    }
+    if (op == "+=" && std::holds_alternative<std::string>(target) && std::holds_alternative<std::string>(right)) {
+        std::get<std::string>(target) += std::get<std::string>(right);
+        return true;
+    }
+    return false;
+}
+
 std::string EvalVisitor::valueToRepr(const Value& val) {
     // Returns the repr of a value (strings are quoted, floats use Python repr, containers recurse)
     if (std::holds_alternative<std::string>(val)) {
@@ -3956,6 +4345,223 @@ std::any EvalVisitor::visitGlobal_stmt(Python3Parser::Global_stmtContext *ctx) {
     return nullptr;
 }
 
+// Fused modular multiply: BigInteger::mulMod reduces against a cached Barrett
+// reciprocal instead of dividing the full double-width product
+Value EvalVisitor::mulModValue(const Value& a, const Value& b, const Value& m) {
+    if (std::holds_alternative<int>(a) && std::holds_alternative<int>(b) && std::holds_alternative<int>(m)) {
+        // |a * b| < 2^62 fits a long long; adjust C++ truncation to Python's floor rule
+        long long divisor = std::get<int>(m);
+        long long r = (static_cast<long long>(std::get<int>(a)) * std::get<int>(b)) % divisor;
+        if (r != 0 && (r < 0) != (divisor < 0)) {
+            r += divisor;
+        }
+        return Value(static_cast<int>(r));
+    }
+    auto asBigInteger = [](const Value& v, BigInteger& storage) -> const BigInteger& {
+        if (std::holds_alternative<BigInteger>(v)) {
+            return std::get<BigInteger>(v);
+        }
+        storage = BigInteger(std::get<int>(v));
+        return storage;
+    };
+    BigInteger aStorage, bStorage, mStorage;
+    return tryDowncastBigInteger(BigInteger::mulMod(asBigInteger(a, aStorage), asBigInteger(b, bStorage),
+                                                    asBigInteger(m, mStorage)));
+}
+
+void EvalVisitor::forgetNodeCaches(antlr4::tree::ParseTree* tree, const std::vector<antlr4::ParserRuleContext*>& operators) {
+    // Few statements are paired, so each is checked for lying in tree
+    for (auto it = mulAssignModuli.begin(); it != mulAssignModuli.end();) {
+        antlr4::tree::ParseTree* node = it->first;
+        while (node && node != tree) {
+            node = node->parent;
+        }
+        it = node ? mulAssignModuli.erase(it) : std::next(it);
+    }
+    if (!foldedConstants.empty()) {
+        for (auto ctx : operators) {
+            foldedConstants.erase(ctx);
+        }
+    }
+}
+
+EvalVisitor::TreeAnalysis EvalVisitor::treeAnalysis() const {
+    TreeAnalysis analysis;
+    analysis.constants.assign(foldedConstants.begin(), foldedConstants.end());
+    analysis.moduli.assign(mulAssignModuli.begin(), mulAssignModuli.end());
+    return analysis;
+}
+
+void EvalVisitor::restoreTreeAnalysis(TreeAnalysis analysis) {
+    for (auto& [node, value] : analysis.constants) {
+        foldedConstants.emplace(node, std::move(value));
+    }
+    for (auto& [node, modulus] : analysis.moduli) {
+        mulAssignModuli.emplace(node, std::move(modulus));
+    }
+}
+
+size_t EvalVisitor::foldConstants(const std::vector<antlr4::ParserRuleContext*>& operators) {
+    // Start and stop tokens are missing only in a tree Python3Parser recovered
+    auto bounded = [](antlr4::ParserRuleContext* ctx) { return ctx->start && ctx->stop; };
+    size_t folded = 0;
+    folding = true;
+    for (size_t i = 0; i < operators.size(); i++) {
+        auto ctx = operators[i];
+        if (!bounded(ctx) || !isConstantExpression(ctx)) {
+            continue;
+        }
+        // Over FOLD_LIMIT or raising, as in 1 // 0: it is left to run time,
+        // and its operands are folded on their own. The checks for those set
+        // foldRejected; the catch is for errors they do not anticipate
+        foldRejected = false;
+        try {
+            auto value = visit(ctx);
+            if (foldRejected || !value.has_value()) {
+                continue;
+            }
+            foldedConstants.emplace(ctx, std::any_cast<Value>(std::move(value)));
+            folded++;
+        } catch (const std::exception&) {
+            continue;
+        }
+        // Skip the operator nodes inside it, which follow it
+        size_t start = ctx->start->getStartIndex();
+        size_t stop = ctx->stop->getStopIndex();
+        while (i + 1 < operators.size() && bounded(operators[i + 1]) &&
+               operators[i + 1]->start->getStartIndex() >= start && operators[i + 1]->stop->getStopIndex() <= stop) {
+            i++;
+        }
+    }
+    folding = false;
+    return folded;
+}
+
+Value EvalVisitor::rejectFold() {
+    foldRejected = true;
+    return Value(0);
+}
+
+bool EvalVisitor::isConstantExpression(antlr4::tree::ParseTree* node) {
+    if (node->getTreeType() != antlr4::tree::ParseTreeType::RULE) {
+        // Operators and literals, as atom decides about the tokens it holds,
+        // but not the error nodes of a recovered parse
+        return node->getTreeType() == antlr4::tree::ParseTreeType::TERMINAL;
+    }
+    auto ctx = static_cast<antlr4::ParserRuleContext*>(node);
+    switch (ctx->getRuleIndex()) {
+        case Python3Parser::RuleAtom: {
+            // A number, string, True, False or None, or a constant in parentheses;
+            // names, lists, tuples and f-strings are not
+            auto first = ctx->children[0];
+            if (first->getTreeType() != antlr4::tree::ParseTreeType::TERMINAL) {
+                return false;
+            }
+            switch (static_cast<antlr4::tree::TerminalNode*>(first)->getSymbol()->getType()) {
+                case Python3Parser::NUMBER:
+                case Python3Parser::STRING:
+                case Python3Parser::TRUE:
+                case Python3Parser::FALSE:
+                case Python3Parser::NONE:
+                    return true;
+                case Python3Parser::OPEN_PAREN:
+                    return ctx->children.size() == 3 && ctx->children[1]->children.size() == 1 &&
+                           isConstantExpression(ctx->children[1]->children[0]);
+                default:
+                    return false;
+            }
+        }
+        case Python3Parser::RuleAtom_expr:
+            // An atom without trailers: calls and subscripts are not folded
+            return ctx->children.size() == 1 && isConstantExpression(ctx->children[0]);
+        case Python3Parser::RuleTest:
+        case Python3Parser::RuleOr_test:
+        case Python3Parser::RuleAnd_test:
+        case Python3Parser::RuleNot_test:
+        case Python3Parser::RuleComparison:
+        case Python3Parser::RuleComp_op:
+        case Python3Parser::RuleArith_expr:
+        case Python3Parser::RuleAddorsub_op:
+        case Python3Parser::RuleTerm:
+        case Python3Parser::RuleMuldivmod_op:
+        case Python3Parser::RuleFactor:
+        case Python3Parser::RulePower:
+            for (auto child : ctx->children) {
+                if (!isConstantExpression(child)) {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+void EvalVisitor::findMulAssignModuli(antlr4::tree::ParseTree* tree) {
+    auto isName = [](const std::string& text) {
+        return !text.empty() && !std::isdigit(static_cast<unsigned char>(text[0])) &&
+            std::all_of(text.begin(), text.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+    };
+    // Statements sit in file_input and suites, which only compound statements
+    // lead to, so no expression is walked
+    std::vector<antlr4::tree::ParseTree*> blocks{tree};
+    while (!blocks.empty()) {
+        antlr4::tree::ParseTree* block = blocks.back();
+        blocks.pop_back();
+        Python3Parser::Expr_stmtContext* mulAssign = nullptr;  // the previous statement, if an `x *= y`
+        for (auto child : block->children) {
+            if (child->getTreeType() != antlr4::tree::ParseTreeType::RULE) {
+                continue;
+            }
+            auto rule = static_cast<antlr4::ParserRuleContext*>(child);
+            switch (rule->getRuleIndex()) {
+                case Python3Parser::RuleStmt: {
+                    auto stmt = static_cast<Python3Parser::StmtContext*>(rule);
+                    if (!stmt->simple_stmt()) {
+                        blocks.push_back(stmt->compound_stmt());
+                        mulAssign = nullptr;
+                        break;
+                    }
+                    auto expr = stmt->simple_stmt()->small_stmt()->expr_stmt();
+                    auto augassign = expr ? expr->augassign() : nullptr;
+                    if (mulAssign && augassign && augassign->getText() == "%=") {
+                        std::string varName = mulAssign->testlist(0)->getText();
+                        std::string text = expr->testlist(1)->getText();
+                        bool isDigits = !text.empty() && text.find_first_not_of("0123456789") == std::string::npos;
+                        if (expr->testlist(0)->getText() == varName && ((isName(text) && text != varName) || isDigits)) {
+                            mulAssignModuli.emplace(mulAssign, text);
+                        }
+                    }
+                    mulAssign = augassign && augassign->getText() == "*=" && isName(expr->testlist(0)->getText()) ? expr : nullptr;
+                    break;
+                }
+                case Python3Parser::RuleCompound_stmt:
+                case Python3Parser::RuleIf_stmt:
+                case Python3Parser::RuleWhile_stmt:
+                case Python3Parser::RuleFuncdef:
+                case Python3Parser::RuleSuite:
+                    blocks.push_back(rule);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+const Value* EvalVisitor::findFollowingModulus(Python3Parser::Expr_stmtContext* ctx, Value& literal) {
+    auto found = mulAssignModuli.find(ctx);
+    if (found == mulAssignModuli.end()) {
+        return nullptr;
+    }
+    const std::string& operand = found->second;
+    if (std::isdigit(static_cast<unsigned char>(operand[0]))) {
+        literal = operand.size() <= 9 ? Value(std::stoi(operand)) : tryDowncastBigInteger(BigInteger(operand));
+        return &literal;
+    }
+    return findVariable(operand);
+}
+
 // Power operation: base ** exp
 Value EvalVisitor::powerValue(const Value& base, const Value& exp) {
     // Convert bools to ints first
@@ -3971,10 +4577,7 @@ Value EvalVisitor::powerValue(const Value& base, const Value& exp) {
     auto toDouble = [](const Value& v) -> double {
         if (std::holds_alternative<int>(v)) return (double)std::get<int>(v);
         if (std::holds_alternative<double>(v)) return std::get<double>(v);
-        if (std::holds_alternative<BigInteger>(v)) {
-            std::string s = std::get<BigInteger>(v).toString();
-            return std::stod(s);
-        }
+        if (std::holds_alternative<BigInteger>(v)) return bigIntegerToFloat(std::get<BigInteger>(v));
         return 0.0;
     };
     
@@ -3988,55 +4591,55 @@ Value EvalVisitor::powerValue(const Value& base, const Value& exp) {
     }
     
     // int ** int or BigInteger ** int
-    // Get exp as integer
+    // Get exp as integer (no decimal round-trip for BigInteger exponents)
     long long expInt = 0;
+    bool expNegative = false;
     if (std::holds_alternative<int>(e)) {
         expInt = std::get<int>(e);
+        expNegative = expInt < 0;
     } else if (std::holds_alternative<BigInteger>(e)) {
-        // For very large exponents, this could be huge. Just convert to long long.
-        std::string s = std::get<BigInteger>(e).toString();
-        try { expInt = std::stoll(s); } catch (...) { expInt = 0; }
+        const BigInteger& bigExp = std::get<BigInteger>(e);
+        expNegative = bigExp.isNegative();
+        if (!expNegative) {
+            if (bigExp.bitLength() >= 63) {
+                // Only 0, 1 and -1 can be raised to an exponent this large
+                if (std::holds_alternative<int>(b)) {
+                    int bi = std::get<int>(b);
+                    if (bi == 0 || bi == 1) return Value(bi);
+                    if (bi == -1) return Value(bigExp.testBit(0) ? -1 : 1);
+                }
+                if (folding) {
+                    return rejectFold();
+                }
+                throw std::runtime_error("OverflowError: exponent too large");
+            }
+            expInt = bigExp.toLongLong();
+        }
     }
     
     // Negative exponent → float result
-    if (expInt < 0) {
+    if (expNegative) {
         double bd = toDouble(b);
-        return Value(std::pow(bd, (double)expInt));
-    }
-    
-    // Non-negative integer exponent: result is BigInteger
-    BigInteger baseBI;
-    if (std::holds_alternative<int>(b)) {
-        baseBI = BigInteger(std::get<int>(b));
-    } else if (std::holds_alternative<BigInteger>(b)) {
-        baseBI = std::get<BigInteger>(b);
-    } else {
-        return Value(0);
+        double ed = std::holds_alternative<int>(e) ? (double)expInt : toDouble(e);
+        return Value(std::pow(bd, ed));
     }
     
-    // Fast exponentiation
-    BigInteger result(1);
-    BigInteger curBase = baseBI;
-    long long ex = expInt;
-    while (ex > 0) {
-        if (ex % 2 == 1) {
-            result = result * curBase;
+    // A fold gives up rather than compute a power the program may never need
+    if (folding) {
+        size_t bits = std::holds_alternative<int>(b) ? BigInteger(std::get<int>(b)).bitLength()
+                    : std::holds_alternative<BigInteger>(b) ? std::get<BigInteger>(b).bitLength() : 0;
+        if (bits > 1 && static_cast<size_t>(expInt) > FOLD_LIMIT / bits) {
+            return rejectFold();
         }
-        curBase = curBase * curBase;
-        ex /= 2;
     }
     
-    // Try to downcast to int if small enough
-    std::string resStr = result.toString();
-    bool isNeg = (resStr.size() > 0 && resStr[0] == '-');
-    std::string absStr = isNeg ? resStr.substr(1) : resStr;
-    if (absStr.length() < 10 || (absStr.length() == 10 && absStr <= "2147483647")) {
-        try {
-            int intVal = std::stoi(resStr);
-            return Value(intVal);
-        } catch (...) {}
+    // Non-negative integer exponent: BigInteger::pow, then back to int if it fits
+    if (std::holds_alternative<int>(b)) {
+        return tryDowncastBigInteger(BigInteger(std::get<int>(b)).pow(expInt));
+    } else if (std::holds_alternative<BigInteger>(b)) {
+        return tryDowncastBigInteger(std::get<BigInteger>(b).pow(expInt));
     }
-    return Value(result);
+    return Value(0);
 }
 
 // Python-style floor division: floors toward -∞
@@ -4311,8 +4914,47 @@ void EvalVisitor::findGlobalInStmt(Python3Parser::StmtContext* stmt, std::set<st
     }
 }
 
+Value EvalVisitor::builtinPow(const std::vector<Value>& args) {
+    if (args.size() == 2) {
+        return powerValue(args[0], args[1]);
+    }
+    if (args.size() != 3) {
+        throw std::runtime_error("TypeError: pow expected 2 or 3 arguments, got " + std::to_string(args.size()));
+    }
+    BigInteger operands[3];
+    for (int k = 0; k < 3; k++) {
+        const Value& v = args[k];
+        if (std::holds_alternative<int>(v)) {
+            operands[k] = BigInteger(std::get<int>(v));
+        } else if (std::holds_alternative<bool>(v)) {
+            operands[k] = BigInteger(std::get<bool>(v) ? 1 : 0);
+        } else if (std::holds_alternative<BigInteger>(v)) {
+            operands[k] = std::get<BigInteger>(v);
+        } else {
+            throw std::runtime_error("TypeError: pow() 3rd argument not allowed unless all arguments are integers");
+        }
+    }
+    return tryDowncastBigInteger(BigInteger::powMod(operands[0], operands[1], operands[2]));
+}
+
+Value EvalVisitor::builtinGcd(const std::vector<Value>& args) {
+    BigInteger result;
+    for (const Value& v : args) {
+        if (std::holds_alternative<int>(v)) {
+            result = BigInteger::gcd(result, BigInteger(std::get<int>(v)));
+        } else if (std::holds_alternative<bool>(v)) {
+            result = BigInteger::gcd(result, BigInteger(std::get<bool>(v) ? 1 : 0));
+        } else if (std::holds_alternative<BigInteger>(v)) {
+            result = BigInteger::gcd(result, std::get<BigInteger>(v));
+        } else {
+            throw std::runtime_error("TypeError: gcd() arguments must be integers");
+        }
+    }
+    return tryDowncastBigInteger(std::move(result));
+}
+
 // Helper: call a built-in function with a single argument (for key= parameter support)
-// Supports: abs, len, str, int, float, bool
+// Supports: abs, gcd, len, str, int, float, bool
 Value EvalVisitor::callBuiltinSingle(const std::string& name, const Value& arg) {
     if (name == "abs") {
         if (std::holds_alternative<int>(arg)) {
@@ -4328,6 +4970,16 @@ Value EvalVisitor::callBuiltinSingle(const std::string& name, const Value& arg)
             return arg;
         }
         return arg;
+    } else if (name == "gcd") {
+        // gcd(x) == abs(x)
+        if (std::holds_alternative<int>(arg)) {
+            return tryDowncastBigInteger(BigInteger::gcd(BigInteger(std::get<int>(arg)), BigInteger()));
+        } else if (std::holds_alternative<bool>(arg)) {
+            return Value(std::get<bool>(arg) ? 1 : 0);
+        } else if (std::holds_alternative<BigInteger>(arg)) {
+            return tryDowncastBigInteger(BigInteger::gcd(std::get<BigInteger>(arg), BigInteger()));
+        }
+        return arg;
     } else if (name == "len") {
         if (std::holds_alternative<std::string>(arg)) {
             return Value((int)std::get<std::string>(arg).size());
@@ -4355,7 +5007,8 @@ Value EvalVisitor::callBuiltinSingle(const std::string& name, const Value& arg)
         if (std::holds_alternative<std::string>(arg)) {
             const std::string& s = std::get<std::string>(arg);
             bool neg = !s.empty() && s[0] == '-';
-            std::string abs_s = neg ? s.substr(1) : s;
+            std::string_view abs_s(s);
+            if (neg) abs_s.remove_prefix(1);
             if (abs_s.length() > 10 || (abs_s.length() == 10 && abs_s > "2147483647"))
                 return Value(BigInteger(s));
             try { return Value(std::stoi(s)); } catch (...) { return Value(0); }
@@ -4369,7 +5022,7 @@ Value EvalVisitor::callBuiltinSingle(const std::string& name, const Value& arg)
             try { return Value(std::stod(std::get<std::string>(arg))); } catch (...) { return Value(0.0); }
         }
         if (std::holds_alternative<BigInteger>(arg)) {
-            try { return Value(std::stod(std::get<BigInteger>(arg).toString())); } catch (...) { return Value(0.0); }
+            try { return Value(bigIntegerToFloat(std::get<BigInteger>(arg))); } catch (...) { return Value(0.0); }
         }
         return Value(0.0);
     } else if (name == "bool") {
@@ -6,10 +6,12 @@
 #include "BigInteger.h"
 #include <variant>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <iomanip>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <set>
 #include <cmath>
 #include <sstream>
@@ -137,6 +139,32 @@ public:
     
     // Global statement
     std::any visitGlobal_stmt(Python3Parser::Global_stmtContext *ctx) override;
+    
+    // Evaluate once, ahead of running a tree, its outermost constant expressions
+    // (operators over literals only); `operators` are the tree's nodes that apply
+    // an operator, outermost first (TreeBuilder::operatorNodes()). Returns how
+    // many were folded
+    size_t foldConstants(const std::vector<antlr4::ParserRuleContext*>& operators);
+    
+    // Pair each `x *= y` statement in tree with an `x %= m` right after it, for
+    // visitExpr_stmt to fuse them (see mulAssignModuli)
+    void findMulAssignModuli(antlr4::tree::ParseTree* tree);
+    
+    // What foldConstants() and findMulAssignModuli() found: it depends only on
+    // the tree, so ProgramCache keeps it with the tree
+    struct TreeAnalysis {
+        std::vector<std::pair<antlr4::tree::ParseTree*, Value>> constants;
+        std::vector<std::pair<Python3Parser::Expr_stmtContext*, std::string>> moduli;
+    };
+    TreeAnalysis treeAnalysis() const;
+    // Takes the analysis saved with a tree instead of running foldConstants()
+    // and findMulAssignModuli() on it
+    void restoreTreeAnalysis(TreeAnalysis analysis);
+    
+    // Drop caches keyed by the nodes of a tree, given its operator nodes; call
+    // before a tree that was run is freed while the visitor lives on, since its
+    // addresses may be reused
+    void forgetNodeCaches(antlr4::tree::ParseTree* tree, const std::vector<antlr4::ParserRuleContext*>& operators);
 
 private:
     // Structure to store function definitions
@@ -167,6 +195,33 @@ private:
     // Track global declarations in current function (used during function body parsing)
     std::set<std::string> currentFunctionGlobals;
     
+    // `x *= y` statements -> operand of the `x %= m` that immediately follows
+    // them (a name or int literal), filled in by findMulAssignModuli() before a
+    // tree runs; only the paired statements are in it, so a program without any
+    // never looks it up
+    std::unordered_map<Python3Parser::Expr_stmtContext*, std::string> mulAssignModuli;
+    
+    // Values of the arith_expr, term, factor and power nodes foldConstants()
+    // evaluated; those visitors return them instead of evaluating again. Only
+    // nodes that apply an operator can be in it, so only those look it up
+    std::unordered_map<antlr4::tree::ParseTree*, Value> foldedConstants;
+    
+    // Set while foldConstants() evaluates: an integer power or string repetition
+    // larger than FOLD_LIMIT bits or characters, or a floor division by zero,
+    // then calls rejectFold() instead of computing or raising, so folding code
+    // that never runs, such as `2 ** 10 ** 9`, costs nothing. No exception is
+    // thrown: in the static binary the first throw costs milliseconds
+    bool folding = false;
+    bool foldRejected = false;  // the expression being folded must be left to run time
+    static constexpr size_t FOLD_LIMIT = 4096;
+    
+    // Sets foldRejected; returns the 0 the expression goes on with, harmless
+    // to any operator and discarded
+    Value rejectFold();
+    
+    // Whether node is an expression over literals only
+    bool isConstantExpression(antlr4::tree::ParseTree* node);
+    
     // Helper to remove quotes from string literals
     std::string unquoteString(const std::string& str);
     
@@ -185,6 +240,13 @@ private:
     // Power operation: base ** exp
     Value powerValue(const Value& base, const Value& exp);
     
+    // (a * b) % m for int/BigInteger operands, m nonzero, Python sign rules
+    Value mulModValue(const Value& a, const Value& b, const Value& m);
+    
+    // Value of `m` in an `x %= m` directly after the `x *= y` statement ctx, if m
+    // is an int literal or a bound name other than x; nullptr otherwise
+    const Value* findFollowingModulus(Python3Parser::Expr_stmtContext* ctx, Value& literal);
+    
     // Python-style floor division for integers (floors toward -∞)
     int pythonFloorDiv(int a, int b);
     
@@ -209,8 +271,34 @@ private:
     // Helper to format a double using Python-style repr (shortest unique representation)
     std::string floatToRepr(double d);
     
+    // Resolve a variable name through local/enclosing/global scope; nullptr if unbound
+    const Value* findVariable(const std::string& varName);
+    
+    // Storage of a factor that is just a variable name (no sign, power or trailers), else nullptr
+    const Value* peekBareName(Python3Parser::FactorContext* factor);
+    
     // Helper to downcast BigInteger to int if it fits (performance optimization)
     Value tryDowncastBigInteger(const BigInteger& bi);
+    Value tryDowncastBigInteger(BigInteger&& bi);  // Temporaries: limbs are moved into the Value
+    
+    // Apply `target op= right` directly on a stored value when the operands allow it
+    // (BigInteger arithmetic, string concatenation); returns false if not handled
+    bool applyAugAssignInPlace(Value& target, const std::string& op, const Value& right);
+    
+    // Python reads the target of `t op= v` before it evaluates v. A right-hand
+    // side without calls cannot change t, so the update may go straight to its
+    // slot; otherwise t is copied into `before` first, to be stored back after.
+    // Returns the value to update
+    Value* augAssignTarget(Value& slot, antlr4::tree::ParseTree* right, Value& before);
+    
+    // Whether evaluating node can run Python code, i.e. it contains a call
+    bool containsCall(antlr4::tree::ParseTree* node);
+    
+    // pow() and gcd() on evaluated arguments, for a direct call or one through
+    // a variable holding the built-in. pow(b, e) is b ** e; pow(b, e, m) and
+    // gcd() run natively on integers
+    Value builtinPow(const std::vector<Value>& args);
+    Value builtinGcd(const std::vector<Value>& args);
     
     // Helper to call a built-in function with a single argument (for key= support)
     Value callBuiltinSingle(const std::string& name, const Value& arg);
@@ -0,0 +1,447 @@
+#include "ProgramCache.h"
+#include "Varint.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+using antlr4::Token;
+using P = Python3Parser;
+
+namespace {
+
+// Two independent 64-bit hashes of the data, mixing eight bytes at a time
+void hashBytes(std::string_view data, uint64_t& first, uint64_t& second) {
+    auto mix = [](uint64_t hash, uint64_t word, uint64_t multiplier) {
+        hash = (hash ^ word) * multiplier;
+        return hash ^ (hash >> 31);
+    };
+    size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i, 8);
+        first = mix(first, word, 0x9E3779B97F4A7C15ULL);
+        second = mix(second, word, 0xC2B2AE3D27D4EB4FULL);
+    }
+    uint64_t tail = 0;
+    if (i < data.size()) {
+        std::memcpy(&tail, data.data() + i, data.size() - i);
+    }
+    first = mix(first, tail ^ data.size(), 0x9E3779B97F4A7C15ULL);
+    second = mix(second, tail ^ data.size(), 0xC2B2AE3D27D4EB4FULL);
+}
+
+// Line and column of a character index, with lines counted as the lexers
+// count them
+class LinePositions {
+public:
+    explicit LinePositions(CodePoints text) {
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '\n') {
+                lineStarts.push_back(i + 1);
+            }
+        }
+    }
+
+    void seek(size_t index) {
+        position = index;
+        if (index < lineStarts[line] || (line + 1 < lineStarts.size() && index >= lineStarts[line + 1])) {
+            line = std::upper_bound(lineStarts.begin(), lineStarts.end(), index) - lineStarts.begin() - 1;
+        }
+    }
+    size_t getLine() const { return line + 1; }
+    size_t getColumn() const { return position - lineStarts[line]; }
+
+private:
+    std::vector<size_t> lineStarts{0};
+    size_t line = 0;  // counted from 0
+    size_t position = 0;
+};
+
+// The kinds of value a folded constant can have
+enum ValueKind : uint8_t { NONE, INT, BOOL, STRING, FLOAT, BIG_INTEGER };
+
+void appendBytes(std::vector<uint8_t>& out, std::string_view bytes) {
+    appendVarint(out, bytes.size());
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+bool readBytes(VarintReader& in, std::string& bytes) {
+    uint64_t size = in.read();
+    const uint8_t* data = in.bytes(size);
+    if (!data) {
+        return false;
+    }
+    bytes.assign(reinterpret_cast<const char*>(data), size);
+    return true;
+}
+
+// false for a kind no constant has, which is then not saved
+bool appendValue(std::vector<uint8_t>& out, const Value& value) {
+    if (std::holds_alternative<std::monostate>(value)) {
+        out.push_back(NONE);
+    } else if (std::holds_alternative<int>(value)) {
+        out.push_back(INT);
+        appendVarint(out, zigzag(std::get<int>(value)));
+    } else if (std::holds_alternative<bool>(value)) {
+        out.push_back(BOOL);
+        out.push_back(std::get<bool>(value));
+    } else if (std::holds_alternative<std::string>(value)) {
+        out.push_back(STRING);
+        appendBytes(out, std::get<std::string>(value));
+    } else if (std::holds_alternative<double>(value)) {
+        uint64_t bits;
+        double number = std::get<double>(value);
+        std::memcpy(&bits, &number, sizeof(bits));
+        out.push_back(FLOAT);
+        appendVarint(out, bits);
+    } else if (std::holds_alternative<BigInteger>(value)) {
+        out.push_back(BIG_INTEGER);
+        appendBytes(out, std::get<BigInteger>(value).toString());
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool readValue(VarintReader& in, Value& value) {
+    const uint8_t* kind = in.bytes(1);
+    if (!kind) {
+        return false;
+    }
+    switch (*kind) {
+        case NONE:
+            value = Value(std::monostate{});
+            return true;
+        case INT:
+            value = Value(static_cast<int>(unzigzag(in.read())));
+            return !in.failed();
+        case BOOL: {
+            const uint8_t* flag = in.bytes(1);
+            value = Value(flag && *flag);
+            return flag;
+        }
+        case STRING: {
+            value = Value(std::string());
+            return readBytes(in, std::get<std::string>(value));
+        }
+        case FLOAT: {
+            uint64_t bits = in.read();
+            double number;
+            std::memcpy(&number, &bits, sizeof(number));
+            value = Value(number);
+            return !in.failed();
+        }
+        case BIG_INTEGER: {
+            std::string digits;
+            if (!readBytes(in, digits)) {
+                return false;
+            }
+            try {
+                value = Value(BigInteger(digits));
+            } catch (const std::invalid_argument&) {
+                return false;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+}
+
+std::unique_ptr<ProgramCache> ProgramCache::fromEnvironment(SourceStream& source) {
+    const char* directory = std::getenv("PYTHON_INTERPRETER_CACHE");
+    if (!directory || !*directory) {
+        return nullptr;
+    }
+    return std::make_unique<ProgramCache>(directory, source);
+}
+
+ProgramCache::ProgramCache(const std::string& directory, SourceStream& source)
+    : source(source), directory(directory) {
+    // A file is only valid for the format and the grammar it was written with,
+    // so both go into its name and check
+    const uint32_t format[] = {VERSION, Python3Parser::RuleArgument + 1, Python3Parser::UNKNOWN_CHAR + 1};
+    uint64_t key = 0;
+    hashBytes(std::string_view(reinterpret_cast<const char*>(format), sizeof(format)), key, check);
+    hashBytes(source.contents(), key, check);
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx.tree", static_cast<unsigned long long>(key));
+    path = directory + name;
+    mkdir(directory.c_str(), 0777);
+}
+
+std::unique_ptr<ProgramCache::Program> ProgramCache::load() {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    void* region = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Header)) {
+        region = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (region == MAP_FAILED) {
+        return nullptr;
+    }
+    auto program = read(static_cast<const char*>(region), info.st_size);
+    munmap(region, info.st_size);
+    if (program) {
+        // Marks the file used, for evict()
+        utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+    }
+    return program;
+}
+
+std::unique_ptr<ProgramCache::Program> ProgramCache::read(const char* data, size_t size) {
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    size -= sizeof(header);
+    if (std::memcmp(header.magic, "PYTR", 4) != 0 || header.version != VERSION ||
+        header.sourceLength != source.size() || header.sourceCheck != check ||
+        header.tokenBytes > size || header.treeBytes > size - header.tokenBytes ||
+        header.tokenCount > header.tokenBytes) {
+        return nullptr;
+    }
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data + sizeof(header));
+
+    auto program = std::make_unique<Program>();
+    program->tokens.reserve(header.tokenCount);
+    std::vector<Token*> tokens;
+    tokens.reserve(header.tokenCount);
+    VarintReader table(bytes, header.tokenBytes);
+    LinePositions lines(source.codePoints());
+    int64_t length = static_cast<int64_t>(source.size());
+    int64_t end = 0;
+    for (size_t i = 0; i < header.tokenCount; i++) {
+        size_t type = static_cast<size_t>(table.read() - 1);
+        int64_t start = end + unzigzag(table.read());
+        int64_t stop = start + unzigzag(table.read()) - 1;
+        if (start < 0 || start > length || stop < start - 1 || stop >= length) {
+            return nullptr;
+        }
+        antlr4::CommonToken& token = program->tokens.emplace_back(
+            std::make_pair<antlr4::TokenSource*, antlr4::CharStream*>(nullptr, &source), type,
+            Token::DEFAULT_CHANNEL, static_cast<size_t>(start), static_cast<size_t>(stop));
+        lines.seek(start);
+        token.setLine(lines.getLine());
+        token.setCharPositionInLine(lines.getColumn());
+        token.setTokenIndex(i);
+        // The only tokens whose text is not their span of the source
+        if (type == P::DEDENT) {
+            token.setText("DEDENT");
+        }
+        tokens.push_back(&token);
+        end = stop + 1;
+    }
+    size_t placed = table.read();
+    for (size_t i = 0, index = 0; i < placed && !table.failed(); i++) {
+        index += table.read();
+        size_t line = table.read();
+        size_t column = table.read();
+        if (index >= tokens.size()) {
+            return nullptr;
+        }
+        program->tokens[index].setLine(line);
+        program->tokens[index].setCharPositionInLine(column);
+    }
+    if (table.failed() || !table.atEnd()) {
+        return nullptr;
+    }
+
+    program->builder = std::make_unique<TreeBuilder>(std::move(tokens));
+    program->tree = program->builder->rebuild(bytes + header.tokenBytes, header.treeBytes, header.nodeCount);
+    if (!program->tree) {
+        return nullptr;
+    }
+
+    // The analysis refers to nodes by their position in the tree
+    const auto& nodes = program->builder->rebuiltNodes();
+    VarintReader rest(bytes + header.tokenBytes + header.treeBytes, size - header.tokenBytes - header.treeBytes);
+    auto node = [&](size_t& position) -> antlr4::ParserRuleContext* {
+        position += rest.read();
+        if (rest.failed() || position >= nodes.size() ||
+            nodes[position]->getTreeType() != antlr4::tree::ParseTreeType::RULE) {
+            return nullptr;
+        }
+        return static_cast<antlr4::ParserRuleContext*>(nodes[position]);
+    };
+    size_t constants = rest.read();
+    for (size_t i = 0, position = 0; i < constants && !rest.failed(); i++) {
+        antlr4::ParserRuleContext* ctx = node(position);
+        Value value;
+        if (!ctx || !readValue(rest, value)) {
+            return nullptr;
+        }
+        program->analysis.constants.emplace_back(ctx, std::move(value));
+    }
+    size_t moduli = rest.read();
+    for (size_t i = 0, position = 0; i < moduli && !rest.failed(); i++) {
+        antlr4::ParserRuleContext* ctx = node(position);
+        std::string modulus;
+        if (!ctx || ctx->getRuleIndex() != P::RuleExpr_stmt || !readBytes(rest, modulus)) {
+            return nullptr;
+        }
+        program->analysis.moduli.emplace_back(static_cast<P::Expr_stmtContext*>(ctx), std::move(modulus));
+    }
+    if (rest.failed() || !rest.atEnd()) {
+        return nullptr;
+    }
+    return program;
+}
+
+void ProgramCache::save(const std::vector<Token*>& tokens, antlr4::tree::ParseTree* tree,
+                        const EvalVisitor::TreeAnalysis& analysis) {
+    std::unordered_map<const antlr4::tree::ParseTree*, size_t> positions;
+    for (auto& constant : analysis.constants) {
+        positions.emplace(constant.first, 0);
+    }
+    for (auto& modulus : analysis.moduli) {
+        positions.emplace(modulus.first, 0);
+    }
+    std::vector<uint8_t> records;
+    size_t nodeCount = TreeBuilder::save(tree, records, positions);
+    if (nodeCount == 0) {
+        return;
+    }
+
+    std::vector<uint8_t> data;
+    data.reserve(tokens.size() * 3 + records.size());
+    LinePositions lines(source.codePoints());
+    std::vector<size_t> placed;  // the tokens whose line or column is stored
+    int64_t end = 0;
+    for (size_t i = 0; i < tokens.size(); i++) {
+        Token* token = tokens[i];
+        if (token->getChannel() != Token::DEFAULT_CHANNEL || token->getTokenIndex() != i) {
+            return;
+        }
+        // size_t(-1), as for the type of EOF or the stop of an empty token
+        // at the start, wraps round to the value before 0
+        int64_t start = static_cast<int64_t>(token->getStartIndex());
+        int64_t stop = static_cast<int64_t>(token->getStopIndex());
+        appendVarint(data, token->getType() + 1);
+        appendVarint(data, zigzag(start - end));
+        appendVarint(data, zigzag(stop - start + 1));
+        end = stop + 1;
+        lines.seek(start);
+        if (lines.getLine() != token->getLine() || lines.getColumn() != token->getCharPositionInLine()) {
+            placed.push_back(i);
+        }
+    }
+    appendVarint(data, placed.size());
+    size_t previous = 0;
+    for (size_t i : placed) {
+        appendVarint(data, i - previous);
+        appendVarint(data, tokens[i]->getLine());
+        appendVarint(data, tokens[i]->getCharPositionInLine());
+        previous = i;
+    }
+
+    Header header;
+    std::memcpy(header.magic, "PYTR", 4);
+    header.version = VERSION;
+    header.sourceLength = source.size();
+    header.sourceCheck = check;
+    header.tokenCount = tokens.size();
+    header.tokenBytes = data.size();
+    header.treeBytes = records.size();
+    header.nodeCount = nodeCount;
+    data.insert(data.end(), records.begin(), records.end());
+
+    // Constants whose value has no stored form are folded again on the next
+    // run; the rest go in the order of their nodes
+    std::vector<std::pair<size_t, const Value*>> constants;
+    for (auto& [node, value] : analysis.constants) {
+        constants.emplace_back(positions[node], &value);
+    }
+    std::sort(constants.begin(), constants.end());
+    std::vector<uint8_t> values;
+    size_t count = 0;
+    previous = 0;
+    for (auto& [position, value] : constants) {
+        size_t mark = values.size();
+        appendVarint(values, position - previous);
+        if (!appendValue(values, *value)) {
+            values.resize(mark);
+            continue;
+        }
+        previous = position;
+        count++;
+    }
+    appendVarint(data, count);
+    data.insert(data.end(), values.begin(), values.end());
+    std::vector<std::pair<size_t, const std::string*>> moduli;
+    for (auto& [node, modulus] : analysis.moduli) {
+        moduli.emplace_back(positions[node], &modulus);
+    }
+    std::sort(moduli.begin(), moduli.end());
+    appendVarint(data, moduli.size());
+    previous = 0;
+    for (auto& [position, modulus] : moduli) {
+        appendVarint(data, position - previous);
+        appendBytes(data, *modulus);
+        previous = position;
+    }
+
+    std::string temporary = path + "." + std::to_string(getpid());
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    if (std::fclose(file) != 0 || !written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return;
+    }
+    evict();
+}
+
+// Removes the least recently used files until the rest fit in MAX_BYTES
+void ProgramCache::evict() {
+    struct File {
+        timespec used;
+        uint64_t size;
+        std::string path;
+    };
+    std::vector<File> files;
+    uint64_t total = 0;
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return;
+    }
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        struct stat info;
+        std::string file = directory + "/" + name;
+        if (name.size() != 21 || name.compare(16, 5, ".tree") != 0 || stat(file.c_str(), &info) != 0) {
+            continue;
+        }
+        files.push_back({info.st_mtim, static_cast<uint64_t>(info.st_size), file});
+        total += info.st_size;
+    }
+    closedir(dir);
+    if (total <= MAX_BYTES) {
+        return;
+    }
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) {
+        return a.used.tv_sec != b.used.tv_sec ? a.used.tv_sec < b.used.tv_sec : a.used.tv_nsec < b.used.tv_nsec;
+    });
+    for (const File& file : files) {
+        if (total <= MAX_BYTES) {
+            break;
+        }
+        if (file.path != path && unlink(file.path.c_str()) == 0) {
+            total -= file.size;
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+#ifndef PYTHON_INTERPRETER_PROGRAMCACHE_H
+#define PYTHON_INTERPRETER_PROGRAMCACHE_H
+
+#include "Evalvisitor.h"
+#include "Python3Parser.h"
+#include "SourceStream.h"
+#include "TreeBuilder.h"
+#include "antlr4-runtime.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * ProgramCache: parsed programs kept on disk, keyed by their source.
+ *
+ * Design Philosophy:
+ * - Opt-in: used only when PYTHON_INTERPRETER_CACHE names a directory
+ * - One file per program, named by a 64-bit hash of the source, the file
+ *   format (VERSION) and the grammar (its rule and token counts); the header
+ *   repeats the source length and a second, independent hash, so a collision
+ *   is a miss rather than a wrong program
+ * - A file holds varints (see Varint.h): the token table, the tree records of
+ *   TreeBuilder::save() and EvalVisitor's analysis of the tree, so a hit
+ *   skips lexing, parsing and folding. It takes about two bytes per source
+ *   character
+ * - A token is stored as its type, the gap from the token before and its
+ *   length. Its text is read from the source, as for lexed tokens, and its
+ *   line and column are counted again from the source; only the tokens placed
+ *   elsewhere, such as DEDENT, have them stored
+ * - On a hit the file is mmap'ed and TreeBuilder::rebuild() constructs the
+ *   tree straight from it
+ * - Only programs TreeBuilder parsed are saved, since a syntax error has to
+ *   be reported on every run. They are saved once they have run, so writing
+ *   the file does not hold up their start
+ * - Files are written under a temporary name and renamed, so a concurrent
+ *   run never reads a partial one; any I/O failure just means no caching
+ * - Once the files outgrow MAX_BYTES, the least recently used go; a hit
+ *   marks its file used
+ */
+class ProgramCache {
+public:
+    // A program loaded from the cache, owning its tokens and tree
+    struct Program {
+        std::vector<antlr4::CommonToken> tokens;  // reserved up front, never moved
+        std::unique_ptr<TreeBuilder> builder;
+        Python3Parser::File_inputContext* tree = nullptr;
+        EvalVisitor::TreeAnalysis analysis;
+    };
+
+    // The cache for this source in the directory PYTHON_INTERPRETER_CACHE
+    // names; nullptr if it is unset or empty
+    static std::unique_ptr<ProgramCache> fromEnvironment(SourceStream& source);
+
+    ProgramCache(const std::string& directory, SourceStream& source);
+
+    // The program saved for the source; nullptr on a miss
+    std::unique_ptr<Program> load();
+    // Saves the tokens and the tree parsed from the source, with the
+    // visitor's analysis of the tree
+    void save(const std::vector<antlr4::Token*>& tokens, antlr4::tree::ParseTree* tree,
+              const EvalVisitor::TreeAnalysis& analysis);
+
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceLength;
+        uint64_t sourceCheck;
+        uint64_t tokenCount;
+        uint64_t tokenBytes;  // then the tree records, then the analysis
+        uint64_t treeBytes;
+        uint64_t nodeCount;
+    };
+    // Bump whenever the header, the token or tree records, the analysis, or
+    // the trees TreeBuilder builds change
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint64_t MAX_BYTES = 256 << 20;
+
+    SourceStream& source;
+    std::string directory;
+    std::string path;
+    uint64_t check = 0;
+
+    std::unique_ptr<Program> read(const char* data, size_t size);
+    void evict();
+};
+
+#endif // PYTHON_INTERPRETER_PROGRAMCACHE_H
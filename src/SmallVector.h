@@ -0,0 +1,204 @@
+#pragma once
+#ifndef PYTHON_INTERPRETER_SMALLVECTOR_H
+#define PYTHON_INTERPRETER_SMALLVECTOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * SmallVector: contiguous storage with a fixed inline buffer.
+ *
+ * Design Philosophy:
+ * - Used for BigInteger limbs, where the vast majority of values created by the
+ *   interpreter are only a couple of limbs wide (int overflow promotions,
+ *   temporaries that are immediately downcast back to int)
+ * - Up to InlineCapacity elements live inside the object itself; no heap
+ *   allocation happens until the size grows past that
+ * - Once spilled, the buffer is kept (clear/resize never shrink capacity),
+ *   mirroring std::vector so BigInteger's buffer-reuse tricks keep working
+ *
+ * Restrictions:
+ * - T must be trivially copyable (limbs are plain integers); elements are moved
+ *   with memcpy and never constructed/destroyed individually
+ * - Only the subset of the std::vector interface BigInteger needs is provided
+ */
+template <typename T, std::size_t InlineCapacity>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector requires trivially copyable elements");
+    static_assert(InlineCapacity > 0, "SmallVector needs at least one inline element");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() : ptr(inlineData()), count(0), cap(InlineCapacity) {}
+
+    SmallVector(const SmallVector& other) : SmallVector() {
+        assignRange(other.ptr, other.count);
+    }
+
+    SmallVector(SmallVector&& other) noexcept : SmallVector() {
+        stealFrom(other);
+    }
+
+    ~SmallVector() {
+        if (!isInline()) {
+            std::free(ptr);
+        }
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            assignRange(other.ptr, other.count);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            if (!isInline()) {
+                std::free(ptr);
+                ptr = inlineData();
+                cap = InlineCapacity;
+            }
+            count = 0;
+            stealFrom(other);
+        }
+        return *this;
+    }
+
+    // Element access
+    T& operator[](size_type i) { return ptr[i]; }
+    const T& operator[](size_type i) const { return ptr[i]; }
+    T& back() { return ptr[count - 1]; }
+    const T& back() const { return ptr[count - 1]; }
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+
+    // Iterators
+    iterator begin() { return ptr; }
+    iterator end() { return ptr + count; }
+    const_iterator begin() const { return ptr; }
+    const_iterator end() const { return ptr + count; }
+
+    // Capacity
+    size_type size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_type capacity() const { return cap; }
+
+    void reserve(size_type n) {
+        if (n > cap) {
+            grow(n);
+        }
+    }
+
+    // Modifiers
+    void clear() { count = 0; }
+
+    void push_back(T value) {
+        if (count == cap) {
+            grow(cap * 2);
+        }
+        ptr[count++] = value;
+    }
+
+    void pop_back() { --count; }
+
+    void resize(size_type n, T value = T()) {
+        reserve(n);
+        for (size_type i = count; i < n; i++) {
+            ptr[i] = value;
+        }
+        count = n;
+    }
+
+    void assign(size_type n, T value) {
+        count = 0;
+        resize(n, value);
+    }
+
+    void swap(SmallVector& other) noexcept {
+        if (this == &other) {
+            return;
+        }
+        if (!isInline() && !other.isInline()) {
+            // Both on the heap: exchange buffers
+            std::swap(ptr, other.ptr);
+            std::swap(count, other.count);
+            std::swap(cap, other.cap);
+            return;
+        }
+        SmallVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    bool operator==(const SmallVector& other) const {
+        return count == other.count &&
+               (count == 0 || std::memcmp(ptr, other.ptr, count * sizeof(T)) == 0);
+    }
+
+    bool operator!=(const SmallVector& other) const {
+        return !(*this == other);
+    }
+
+private:
+    T* ptr;                 // inlineData() or a malloc'd block
+    size_type count;        // Number of live elements
+    size_type cap;          // Capacity of the current buffer
+    alignas(T) unsigned char inlineBuffer[InlineCapacity * sizeof(T)];
+
+    T* inlineData() { return reinterpret_cast<T*>(inlineBuffer); }
+    bool isInline() const { return ptr == reinterpret_cast<const T*>(inlineBuffer); }
+
+    void grow(size_type n) {
+        // Geometric growth so repeated push_back stays amortized O(1)
+        size_type newCap = cap * 2 > n ? cap * 2 : n;
+        T* block = static_cast<T*>(std::malloc(newCap * sizeof(T)));
+        if (!block) {
+            throw std::bad_alloc();
+        }
+        if (count > 0) {
+            std::memcpy(block, ptr, count * sizeof(T));
+        }
+        if (!isInline()) {
+            std::free(ptr);
+        }
+        ptr = block;
+        cap = newCap;
+    }
+
+    void assignRange(const T* src, size_type n) {
+        count = 0;
+        reserve(n);
+        if (n > 0) {
+            std::memcpy(ptr, src, n * sizeof(T));
+        }
+        count = n;
+    }
+
+    // Precondition: this is empty and inline
+    void stealFrom(SmallVector& other) noexcept {
+        if (other.isInline()) {
+            if (other.count > 0) {
+                std::memcpy(ptr, other.ptr, other.count * sizeof(T));
+            }
+            count = other.count;
+        } else {
+            ptr = other.ptr;
+            count = other.count;
+            cap = other.cap;
+            other.ptr = other.inlineData();
+            other.cap = InlineCapacity;
+        }
+        other.count = 0;
+    }
+};
+
+#endif // PYTHON_INTERPRETER_SMALLVECTOR_H
@@ -0,0 +1,163 @@
+#include "SourceStream.h"
+#include "support/Utf8.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using antlr4::IntStream;
+
+SourceStream::SourceStream(int fd) {
+    load(fd);
+    if (length >= 3 && std::memcmp(bytes, "\xef\xbb\xbf", 3) == 0) {
+        bytes += 3;
+        length -= 3;
+    }
+    if (std::any_of(bytes, bytes + length, [](char c) { return static_cast<unsigned char>(c) > 0x7F; })) {
+        auto wide = antlrcpp::Utf8::strictDecode(std::string_view(bytes, length));
+        if (!wide) {
+            throw antlr4::IllegalArgumentException("UTF-8 string contains an illegal byte sequence");
+        }
+        decoded = std::move(*wide);
+        unload();
+        bytes = nullptr;
+        length = decoded.size();
+    }
+}
+
+SourceStream::~SourceStream() {
+    unload();
+}
+
+void SourceStream::load(int fd) {
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 && lseek(fd, 0, SEEK_CUR) == 0) {
+        void* region = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (region != MAP_FAILED) {
+            mapped = region;
+            mappedLength = info.st_size;
+            bytes = static_cast<const char*>(region);
+            length = mappedLength;
+            return;
+        }
+    }
+    size_t size = 0;
+    buffer.resize(64 * 1024);
+    for (;;) {
+        if (size == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        ssize_t got = read(fd, &buffer[size], buffer.size() - size);
+        if (got == 0) {
+            break;
+        }
+        if (got < 0) {
+            // Interrupted before any byte arrived: try again. Any other error
+            // must not leave a truncated program to run
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "cannot read the program");
+        }
+        size += got;
+    }
+    buffer.resize(size);
+    bytes = buffer.data();
+    length = size;
+}
+
+void SourceStream::unload() {
+    if (mapped) {
+        munmap(mapped, mappedLength);
+        mapped = nullptr;
+    }
+    std::string().swap(buffer);
+}
+
+// The IntStream and CharStream members follow ANTLRInputStream
+
+void SourceStream::consume() {
+    if (p >= length) {
+        throw antlr4::IllegalStateException("cannot consume EOF");
+    }
+    p++;
+}
+
+size_t SourceStream::LA(ssize_t i) {
+    if (i == 0) {
+        return 0;
+    }
+    ssize_t position = static_cast<ssize_t>(p);
+    if (i < 0) {
+        i++;
+        if (position + i - 1 < 0) {
+            return IntStream::EOF;
+        }
+    }
+    if (position + i - 1 >= static_cast<ssize_t>(length)) {
+        return IntStream::EOF;
+    }
+    return codePoints()[static_cast<size_t>(position + i - 1)];
+}
+
+ssize_t SourceStream::mark() {
+    return -1;
+}
+
+void SourceStream::release(ssize_t) {}
+
+size_t SourceStream::index() {
+    return p;
+}
+
+void SourceStream::seek(size_t index) {
+    p = std::min(index, length);
+}
+
+size_t SourceStream::size() {
+    return length;
+}
+
+std::string SourceStream::getSourceName() const {
+    return IntStream::UNKNOWN_SOURCE_NAME;
+}
+
+std::string SourceStream::getText(const antlr4::misc::Interval& interval) {
+    if (interval.a < 0 || interval.b < 0) {
+        return "";
+    }
+    size_t start = interval.a;
+    size_t stop = std::min(static_cast<size_t>(interval.b), length - 1);
+    if (start >= length || stop < start) {
+        return "";
+    }
+    if (bytes) {
+        return std::string(bytes + start, stop - start + 1);
+    }
+    return antlrcpp::Utf8::lenientEncode(std::u32string_view(decoded.data() + start, stop - start + 1));
+}
+
+std::string SourceStream::toString() const {
+    if (bytes) {
+        return std::string(bytes, length);
+    }
+    return antlrcpp::Utf8::lenientEncode(decoded);
+}
+
+CodePoints SourceStream::codePoints() const {
+    if (bytes) {
+        return CodePoints(bytes, length);
+    }
+    return CodePoints(decoded.data(), decoded.size());
+}
+
+std::string_view SourceStream::contents() const {
+    if (bytes) {
+        return std::string_view(bytes, length);
+    }
+    return std::string_view(reinterpret_cast<const char*>(decoded.data()), decoded.size() * sizeof(char32_t));
+}
@@ -0,0 +1,82 @@
+#pragma once
+#ifndef PYTHON_INTERPRETER_SOURCESTREAM_H
+#define PYTHON_INTERPRETER_SOURCESTREAM_H
+
+#include "antlr4-runtime.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only view of a sequence of code points stored either as bytes (an
+// ASCII input) or as UTF-32
+class CodePoints {
+public:
+    CodePoints() = default;
+    CodePoints(const char* bytes, size_t length) : bytes(bytes), length(length) {}
+    CodePoints(const char32_t* wide, size_t length) : wide(wide), length(length) {}
+
+    char32_t operator[](size_t i) const {
+        return bytes ? static_cast<unsigned char>(bytes[i]) : wide[i];
+    }
+    size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;
+    const char32_t* wide = nullptr;
+    size_t length = 0;
+};
+
+/**
+ * SourceStream: antlr4::CharStream over the raw bytes of the program.
+ *
+ * Design Philosophy:
+ * - The input is loaded in bulk: one mmap if it is a regular file, otherwise
+ *   read() into a buffer that doubles as needed; no std::istream. A read
+ *   error other than EINTR throws std::system_error
+ * - An ASCII input, which is nearly every script, is served straight from
+ *   those bytes: a character index is a byte offset and a token's text is a
+ *   substring, so the input costs about one byte per character
+ * - Any other input is decoded once to UTF-32 as ANTLRInputStream does, and
+ *   the bytes are released
+ * - Behaves like ANTLRInputStream(std::cin) otherwise: a UTF-8 byte order
+ *   mark is skipped and invalid UTF-8 throws IllegalArgumentException
+ * - Tokenizer reads the code points through codePoints() instead of decoding
+ *   a copy of its own
+ */
+class SourceStream : public antlr4::CharStream {
+public:
+    // Reads everything left on the file descriptor
+    explicit SourceStream(int fd);
+    ~SourceStream() override;
+    SourceStream(const SourceStream&) = delete;
+    SourceStream& operator=(const SourceStream&) = delete;
+
+    void consume() override;
+    size_t LA(ssize_t i) override;
+    ssize_t mark() override;
+    void release(ssize_t marker) override;
+    size_t index() override;
+    void seek(size_t index) override;
+    size_t size() override;
+    std::string getSourceName() const override;
+    std::string getText(const antlr4::misc::Interval& interval) override;
+    std::string toString() const override;
+
+    CodePoints codePoints() const;
+    // The stored input: its bytes, or its UTF-32 code units once decoded
+    std::string_view contents() const;
+
+private:
+    void* mapped = nullptr;  // the mmap'ed file, if the input is one
+    size_t mappedLength = 0;
+    std::string buffer;      // what read() returned otherwise
+    const char* bytes = nullptr;  // the ASCII input; nullptr once decoded
+    size_t length = 0;
+    std::u32string decoded;  // the input if it is not ASCII
+    size_t p = 0;
+
+    void load(int fd);
+    void unload();
+};
+
+#endif // PYTHON_INTERPRETER_SOURCESTREAM_H
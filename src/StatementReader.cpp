@@ -0,0 +1,88 @@
+#include "StatementReader.h"
+
+using antlr4::Token;
+using P = Python3Parser;
+
+StatementReader::StatementReader(antlr4::TokenSource& source, bool antlrParser)
+    : source(source), antlrParser(antlrParser) {}
+
+std::unique_ptr<StatementReader::Statement> StatementReader::next() {
+    auto statement = std::make_unique<Statement>();
+    if (finished || !readTokens(statement->tokens)) {
+        return nullptr;
+    }
+    std::vector<Token*> tokens;
+    tokens.reserve(statement->tokens.size());
+    for (const auto& token : statement->tokens) {
+        tokens.push_back(token.get());
+        if (token->getType() == P::DEF) {
+            statement->definesFunction = true;
+        }
+    }
+
+    if (!antlrParser) {
+        statement->builder = std::make_unique<TreeBuilder>(std::move(tokens));
+        statement->tree = statement->builder->parseStatement();
+        if (statement->tree) {
+            return statement;
+        }
+        statement->builder.reset();
+    }
+    statement->source = std::make_unique<antlr4::ListTokenSource>(std::move(statement->tokens));
+    statement->stream = std::make_unique<antlr4::CommonTokenStream>(statement->source.get());
+    statement->parser = std::make_unique<Python3Parser>(statement->stream.get());
+    statement->tree = statement->parser->file_input();
+    return statement;
+}
+
+std::unique_ptr<Token> StatementReader::take() {
+    if (lookahead) {
+        return std::move(lookahead);
+    }
+    return source.nextToken();
+}
+
+bool StatementReader::readTokens(std::vector<std::unique_ptr<Token>>& tokens) {
+    size_t depth = 0;
+    for (;;) {
+        std::unique_ptr<Token> token = take();
+        size_t type = token->getType();
+        if (type == Token::EOF) {
+            finished = true;
+            if (tokens.empty()) {
+                return false;
+            }
+            tokens.push_back(std::move(token));
+            return true;
+        }
+        if (type == P::NEWLINE && tokens.empty()) {
+            continue;
+        }
+        tokens.push_back(std::move(token));
+        if (type == P::INDENT) {
+            depth++;
+        } else if (type == P::DEDENT && depth > 0) {
+            depth--;
+        }
+        // A line ending in ':' is followed by its suite, even if that is
+        // missing its INDENT
+        bool opensSuite = type == P::NEWLINE && tokens.size() > 1 && tokens[tokens.size() - 2]->getType() == P::COLON;
+        if (depth == 0 && (type == P::NEWLINE || type == P::DEDENT) && !opensSuite) {
+            lookahead = take();
+            size_t nextType = lookahead->getType();
+            if (nextType != P::INDENT && nextType != P::ELIF && nextType != P::ELSE) {
+                break;
+            }
+        }
+    }
+
+    // Stands in for the rest of the input, placed like the EOF token at the
+    // start of the next statement
+    auto eof = std::make_unique<antlr4::CommonToken>(Token::EOF, "<EOF>");
+    eof->setLine(lookahead->getLine());
+    eof->setCharPositionInLine(lookahead->getCharPositionInLine());
+    eof->setStartIndex(lookahead->getStartIndex());
+    eof->setStopIndex(lookahead->getStartIndex() - 1);
+    tokens.push_back(std::move(eof));
+    return true;
+}
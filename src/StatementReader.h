@@ -0,0 +1,58 @@
+#pragma once
+#ifndef PYTHON_INTERPRETER_STATEMENTREADER_H
+#define PYTHON_INTERPRETER_STATEMENTREADER_H
+
+#include "Python3Parser.h"
+#include "TreeBuilder.h"
+#include "antlr4-runtime.h"
+#include <memory>
+#include <vector>
+
+/**
+ * StatementReader: reads a token source one top-level statement at a time.
+ *
+ * Design Philosophy:
+ * - Pulls tokens only as far as the end of the next top-level statement:
+ *   a NEWLINE or DEDENT back at indentation depth 0 that does not end a
+ *   line with ':' and is not followed by INDENT, `elif` or `else`. Blank
+ *   lines between statements are dropped
+ * - Each statement owns its tokens and its tree, so `code --stream` can run
+ *   it and free it before reading further; memory stays proportional to the
+ *   largest statement rather than to the script
+ * - Parses with TreeBuilder; if that fails, Python3Parser parses the
+ *   statement's tokens as a file_input, reporting the syntax error and
+ *   recovering as it would in the whole file
+ */
+class StatementReader {
+public:
+    // One top-level statement with the tokens and nodes its tree refers to
+    struct Statement {
+        antlr4::tree::ParseTree* tree = nullptr;  // a stmt, or a file_input from Python3Parser
+        bool definesFunction = false;  // contains a funcdef, whose suite functions keep pointing to
+
+        std::vector<std::unique_ptr<antlr4::Token>> tokens;
+        std::unique_ptr<TreeBuilder> builder;
+        std::unique_ptr<antlr4::ListTokenSource> source;
+        std::unique_ptr<antlr4::CommonTokenStream> stream;
+        std::unique_ptr<Python3Parser> parser;
+    };
+
+    // antlrParser: always parse with Python3Parser, as `--antlr-parser` does
+    StatementReader(antlr4::TokenSource& source, bool antlrParser);
+
+    // The next statement, parsed; nullptr at end of input
+    std::unique_ptr<Statement> next();
+
+private:
+    antlr4::TokenSource& source;
+    bool antlrParser;
+    bool finished = false;
+    std::unique_ptr<antlr4::Token> lookahead;
+
+    std::unique_ptr<antlr4::Token> take();
+    // Moves the next statement's tokens and an EOF token into `tokens`;
+    // false at end of input
+    bool readTokens(std::vector<std::unique_ptr<antlr4::Token>>& tokens);
+};
+
+#endif // PYTHON_INTERPRETER_STATEMENTREADER_H
@@ -0,0 +1,726 @@
+#include "Tokenizer.h"
+#include "Python3Lexer.h"
+#include "SourceStream.h"
+#include "support/Utf8.h"
+#include <algorithm>
+#include <unordered_set>
+
+using antlr4::Token;
+
+namespace {
+
+enum : unsigned char {
+    ID_START = 1,
+    ID_CONTINUE = 2,
+    DIGIT = 4,
+    SPACE = 8,        // ' ' and '\t'
+    LINE_BREAK = 16,  // '\r', '\n' and '\f'
+};
+
+struct CharTable {
+    unsigned char flags[128] = {};
+
+    CharTable() {
+        for (int c = 'a'; c <= 'z'; c++) {
+            flags[c] = ID_START | ID_CONTINUE;
+            flags[c - 'a' + 'A'] = ID_START | ID_CONTINUE;
+        }
+        flags['_'] = ID_START | ID_CONTINUE;
+        for (int c = '0'; c <= '9'; c++) {
+            flags[c] = ID_CONTINUE | DIGIT;
+        }
+        flags[' '] = flags['\t'] = SPACE;
+        flags['\r'] = flags['\n'] = flags['\f'] = LINE_BREAK;
+    }
+};
+
+const CharTable table;
+
+inline bool is(char32_t c, unsigned char flag) {
+    return c < 128 && (table.flags[c] & flag);
+}
+
+// ID_START and ID_CONTINUE beyond ASCII, taken from the generated lexer's
+// ATN: every alternative of both fragments matches a single character, so
+// the labels of the first transitions out of the rule are the whole set
+struct IdentifierSets {
+    antlr4::misc::IntervalSet start;
+    antlr4::misc::IntervalSet rest;
+};
+
+antlr4::misc::IntervalSet firstCharacters(const antlr4::atn::ATN& atn, size_t ruleIndex) {
+    antlr4::misc::IntervalSet set;
+    std::vector<antlr4::atn::ATNState*> stack{atn.ruleToStartState[ruleIndex]};
+    std::unordered_set<antlr4::atn::ATNState*> seen;
+    while (!stack.empty()) {
+        antlr4::atn::ATNState* state = stack.back();
+        stack.pop_back();
+        if (!seen.insert(state).second || state->getStateType() == antlr4::atn::ATNStateType::RULE_STOP) {
+            continue;
+        }
+        for (const auto& transition : state->transitions) {
+            if (transition->isEpsilon()) {
+                stack.push_back(transition->target);
+            } else {
+                set.addAll(transition->label());
+            }
+        }
+    }
+    return set;
+}
+
+const IdentifierSets& identifierSets() {
+    static const IdentifierSets sets = [] {
+        antlr4::ANTLRInputStream empty("");
+        Python3Lexer lexer(&empty);
+        antlr4::Lexer& base = lexer;
+        const std::vector<std::string>& names = base.getRuleNames();
+        auto rule = [&](const char* name) {
+            return (size_t)(std::find(names.begin(), names.end(), name) - names.begin());
+        };
+        return IdentifierSets{firstCharacters(base.getATN(), rule("ID_START")),
+                              firstCharacters(base.getATN(), rule("ID_CONTINUE"))};
+    }();
+    return sets;
+}
+
+inline bool isIdentifierStart(char32_t c) {
+    return c < 128 ? (table.flags[c] & ID_START) != 0 : identifierSets().start.contains((size_t)c);
+}
+
+inline bool isIdentifierContinue(char32_t c) {
+    return c < 128 ? (table.flags[c] & ID_CONTINUE) != 0 : identifierSets().rest.contains((size_t)c);
+}
+
+inline bool isHexDigit(char32_t c) {
+    return is(c, DIGIT) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+
+struct Keyword {
+    const char* text;
+    size_t length;
+    size_t type;
+};
+
+const Keyword KEYWORDS[] = {
+    {"def", 3, Python3Lexer::DEF}, {"return", 6, Python3Lexer::RETURN},
+    {"if", 2, Python3Lexer::IF}, {"elif", 4, Python3Lexer::ELIF},
+    {"else", 4, Python3Lexer::ELSE}, {"while", 5, Python3Lexer::WHILE},
+    {"for", 3, Python3Lexer::FOR}, {"in", 2, Python3Lexer::IN},
+    {"or", 2, Python3Lexer::OR}, {"and", 3, Python3Lexer::AND},
+    {"not", 3, Python3Lexer::NOT}, {"None", 4, Python3Lexer::NONE},
+    {"True", 4, Python3Lexer::TRUE}, {"False", 5, Python3Lexer::FALSE},
+    {"continue", 8, Python3Lexer::CONTINUE}, {"break", 5, Python3Lexer::BREAK},
+    {"global", 6, Python3Lexer::GLOBAL},
+};
+
+}
+
+Tokenizer::Tokenizer(antlr4::CharStream* input) : input(input) {
+    if (auto source = dynamic_cast<SourceStream*>(input)) {
+        text = source->codePoints();
+    } else {
+        decoded = antlrcpp::Utf8::lenientDecode(input->toString());
+        text = CodePoints(decoded.data(), decoded.size());
+    }
+}
+
+std::unique_ptr<Token> Tokenizer::nextToken() {
+    // Python3Lexer::nextToken: at end of input with indentation still open,
+    // emit a line break, the DEDENTs and an EOF token
+    if (pos == text.size() && !indents.empty()) {
+        emitTrailing(Python3Lexer::NEWLINE, 1);
+        while (!indents.empty()) {
+            emitTrailing(Python3Lexer::DEDENT, 0);
+            pending.back()->setText("DEDENT");
+            indents.pop_back();
+        }
+        emitTrailing(Token::EOF, 5);
+    }
+    while (pending.empty()) {
+        if (pos == text.size()) {
+            emit(Token::EOF, pos, pos - 1, line, column);
+            break;
+        }
+        scanToken();
+    }
+    std::unique_ptr<Token> token = std::move(pending.front());
+    pending.pop_front();
+    return token;
+}
+
+size_t Tokenizer::getLine() const {
+    return line;
+}
+
+size_t Tokenizer::getCharPositionInLine() {
+    return column;
+}
+
+antlr4::CharStream* Tokenizer::getInputStream() {
+    return input;
+}
+
+std::string Tokenizer::getSourceName() {
+    return input->getSourceName();
+}
+
+antlr4::TokenFactory<antlr4::CommonToken>* Tokenizer::getTokenFactory() {
+    return antlr4::CommonTokenFactory::DEFAULT.get();
+}
+
+void Tokenizer::scanToken() {
+    if (formatMode > 0 && !exprMode) {
+        scanFormatText();
+        return;
+    }
+
+    size_t start = pos;
+    size_t n = text.size();
+    char32_t c = text[start];
+    if (is(c, SPACE)) {
+        size_t end = start + 1;
+        while (end < n && is(text[end], SPACE)) {
+            end++;
+        }
+        advance(end);
+        // Leading indentation is NEWLINE's {atStartOfInput()}? SPACES
+        if (start == 0) {
+            newline(start);
+        }
+        return;
+    }
+    if (is(c, LINE_BREAK)) {
+        size_t end = start + 1;
+        if (c == '\r' && end < n && text[end] == '\n') {
+            end++;
+        }
+        while (end < n && is(text[end], SPACE)) {
+            end++;
+        }
+        advance(end);
+        newline(start);
+        return;
+    }
+    if (c == '#') {
+        size_t end = start + 1;
+        while (end < n && !is(text[end], LINE_BREAK)) {
+            end++;
+        }
+        advance(end);
+        return;
+    }
+
+    size_t end = start + 1;
+    size_t type = Python3Lexer::UNKNOWN_CHAR;
+    if (c == '\\') {
+        size_t joined = lineJoiningEnd(start);
+        if (joined > start) {
+            advance(joined);
+            return;
+        }
+    } else if (c == '"' || c == '\'') {
+        size_t string = stringEnd(start, false);
+        if (string > start) {
+            end = string;
+            type = Python3Lexer::STRING;
+        }
+    } else if (isIdentifierStart(c)) {
+        end = identifierEnd(start);
+        type = keywordType(start, end);
+        size_t string = prefixedStringEnd(start, end, true);
+        if (string > end) {
+            end = string;
+            type = Python3Lexer::STRING;
+        } else if (c == 'f' && end == start + 1 && end < n && text[end] == '"') {
+            end++;
+            type = Python3Lexer::FORMAT_QUOTATION;
+        }
+    } else if (is(c, DIGIT) || (c == '.' && start + 1 < n && is(text[start + 1], DIGIT))) {
+        end = std::max(integerEnd(start, true), floatEnd(start));
+        type = Python3Lexer::NUMBER;
+    } else {
+        size_t operatorType;
+        size_t op = operatorEnd(start, operatorType);
+        if (op > start) {
+            end = op;
+            type = operatorType;
+        }
+    }
+    emitMatch(type, end);
+}
+
+// The text part of an f-string, where only FORMAT_STRING_LITERAL and the
+// rules without a predicate can match. FORMAT_STRING_LITERAL consumes
+// nearly everything, but a longer match of another rule still wins (a
+// comment runs to the end of the line, a bytes literal can contain '"'),
+// and so does one of the same length defined earlier in the grammar
+void Tokenizer::scanFormatText() {
+    size_t start = pos;
+    size_t n = text.size();
+    char32_t c = text[start];
+    if (c == '"') {
+        emitMatch(Python3Lexer::QUOTATION, start + 1);
+        return;
+    }
+    if (is(c, LINE_BREAK)) {
+        size_t end = start + 1;
+        if (c == '\r' && end < n && text[end] == '\n') {
+            end++;
+        }
+        while (end < n && is(text[end], SPACE)) {
+            end++;
+        }
+        advance(end);
+        newline(start);
+        return;
+    }
+    if ((c == '{' || c == '}') && !(start + 1 < n && text[start + 1] == c)) {
+        emitMatch(c == '{' ? Python3Lexer::OPEN_BRACE : Python3Lexer::CLOSE_BRACE, start + 1);
+        return;
+    }
+
+    size_t end = start;
+    size_t type = Python3Lexer::UNKNOWN_CHAR;
+    auto consider = [&](size_t candidateEnd, size_t candidateType) {
+        if (candidateEnd > end || (candidateEnd == end && candidateEnd > start && candidateType < type)) {
+            end = candidateEnd;
+            type = candidateType;
+        }
+    };
+    consider(formatTextEnd(start), Python3Lexer::FORMAT_STRING_LITERAL);
+    if (isIdentifierStart(c)) {
+        consider(prefixedStringEnd(start, identifierEnd(start), false), Python3Lexer::STRING);
+        if (c == 'f' && start + 1 < n && text[start + 1] == '"') {
+            consider(start + 2, Python3Lexer::FORMAT_QUOTATION);
+        }
+    }
+    if (is(c, DIGIT) || c == '.') {
+        consider(floatEnd(start), Python3Lexer::NUMBER);
+        consider(integerEnd(start, false), Python3Lexer::INTEGER);
+    }
+    size_t operatorType = Python3Lexer::UNKNOWN_CHAR;
+    consider(operatorEnd(start, operatorType), operatorType);
+    if (is(c, SPACE)) {
+        size_t spaces = start + 1;
+        while (spaces < n && is(text[spaces], SPACE)) {
+            spaces++;
+        }
+        consider(spaces, Python3Lexer::SKIP_);
+    } else if (c == '#') {
+        size_t comment = start + 1;
+        while (comment < n && !is(text[comment], LINE_BREAK)) {
+            comment++;
+        }
+        consider(comment, Python3Lexer::SKIP_);
+    } else if (c == '\\') {
+        consider(lineJoiningEnd(start), Python3Lexer::SKIP_);
+    }
+    consider(start + 1, Python3Lexer::UNKNOWN_CHAR);
+
+    if (type == Python3Lexer::SKIP_) {
+        advance(end);
+    } else {
+        emitMatch(type, end);
+    }
+}
+
+void Tokenizer::newline(size_t start) {
+    size_t breaks = 0;
+    int indent = 0;
+    for (size_t i = start; i < pos; i++) {
+        if (is(text[i], LINE_BREAK)) {
+            breaks++;
+        } else if (text[i] == '\t') {
+            indent += 8 - indent % 8;
+        } else {
+            indent++;
+        }
+    }
+    // Inside brackets or on a blank or comment-only line there is no
+    // NEWLINE and the indentation does not count
+    char32_t next = pos < text.size() ? text[pos] : 0;
+    if (opened > 0 || is(next, LINE_BREAK) || next == '#') {
+        return;
+    }
+    emitTrailing(Python3Lexer::NEWLINE, breaks);
+    int previous = indents.empty() ? 0 : indents.back();
+    if (indent > previous) {
+        indents.push_back(indent);
+        emitTrailing(Python3Lexer::INDENT, pos - start - breaks);
+    } else {
+        while (!indents.empty() && indents.back() > indent) {
+            emitTrailing(Python3Lexer::DEDENT, 0);
+            pending.back()->setText("DEDENT");
+            indents.pop_back();
+        }
+    }
+}
+
+void Tokenizer::advance(size_t end) {
+    for (; pos < end; pos++) {
+        if (text[pos] == '\n') {
+            line++;
+            column = 0;
+        } else {
+            column++;
+        }
+    }
+}
+
+void Tokenizer::emit(size_t type, size_t start, size_t stop, size_t tokenLine, size_t tokenColumn) {
+    auto token = std::make_unique<antlr4::CommonToken>(std::make_pair(this, input), type,
+                                                       Token::DEFAULT_CHANNEL, start, stop);
+    token->setLine(tokenLine);
+    token->setCharPositionInLine(tokenColumn);
+    pending.push_back(std::move(token));
+}
+
+void Tokenizer::emitMatch(size_t type, size_t end) {
+    size_t start = pos;
+    size_t startLine = line;
+    size_t startColumn = column;
+    advance(end);
+    emit(type, start, end - 1, startLine, startColumn);
+    switch (type) {
+        case Python3Lexer::OPEN_PAREN:
+        case Python3Lexer::OPEN_BRACK:
+            opened++;
+            break;
+        case Python3Lexer::CLOSE_PAREN:
+        case Python3Lexer::CLOSE_BRACK:
+            opened--;
+            break;
+        case Python3Lexer::OPEN_BRACE:
+            opened++;
+            exprMode = true;
+            break;
+        case Python3Lexer::CLOSE_BRACE:
+            opened--;
+            exprMode = false;
+            break;
+        case Python3Lexer::FORMAT_QUOTATION:
+            formatMode++;
+            exprMode = false;
+            break;
+        case Python3Lexer::QUOTATION:
+            formatMode--;
+            if (formatMode > 0) {
+                exprMode = true;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void Tokenizer::emitTrailing(size_t type, size_t length) {
+    size_t stop = pos - 1;
+    size_t start = length == 0 ? stop : stop - length + 1;
+    emit(type, start, stop, line, column);
+}
+
+size_t Tokenizer::identifierEnd(size_t start) const {
+    size_t end = start + 1;
+    while (end < text.size() && isIdentifierContinue(text[end])) {
+        end++;
+    }
+    return end;
+}
+
+// A short or long string (or bytes) literal whose opening quote is at start
+size_t Tokenizer::stringEnd(size_t start, bool bytes) const {
+    size_t n = text.size();
+    char32_t quote = text[start];
+    if (start + 2 < n && text[start + 1] == quote && text[start + 2] == quote) {
+        // Non-greedy: the first unescaped triple quote closes the literal
+        size_t i = start + 3;
+        while (i < n) {
+            char32_t c = text[i];
+            if (bytes && c > 0x7F) {
+                break;
+            }
+            if (c == '\\') {
+                if (i + 1 >= n || (bytes && text[i + 1] > 0x7F)) {
+                    break;
+                }
+                i += 2;
+            } else if (c == quote && i + 2 < n && text[i + 1] == quote && text[i + 2] == quote) {
+                return i + 3;
+            } else {
+                i++;
+            }
+        }
+    }
+    // Falls back to a short literal, which for an unclosed ''' is ''
+    for (size_t i = start + 1; i < n;) {
+        char32_t c = text[i];
+        if (c == quote) {
+            return i + 1;
+        }
+        if (c == '\\') {
+            if (i + 1 >= n || (bytes && text[i + 1] > 0x7F)) {
+                return start;
+            }
+            // '\\' NEWLINE also takes a \r\n pair; bytes only '\\' and one character
+            i += 2;
+            if (!bytes && text[i - 1] == '\r' && i < n && text[i] == '\n') {
+                i++;
+            }
+        } else if (c == '\r' || c == '\n' || (!bytes && c == '\f') || (bytes && c > 0x7F)) {
+            return start;
+        } else {
+            i++;
+        }
+    }
+    return start;
+}
+
+// [prefix] string where the identifier characters from start to prefixEnd are
+// the prefix: r, u, fr, rf for strings, b, br, rb for bytes, in either case
+size_t Tokenizer::prefixedStringEnd(size_t start, size_t prefixEnd, bool allowStrings) const {
+    if (prefixEnd >= text.size() || (text[prefixEnd] != '"' && text[prefixEnd] != '\'') ||
+        prefixEnd - start > 2) {
+        return start;
+    }
+    char32_t first = text[start] | 0x20;
+    char32_t second = prefixEnd - start == 2 ? text[start + 1] | 0x20 : 0;
+    bool bytes = (first == 'b' && (second == 0 || second == 'r')) || (first == 'r' && second == 'b');
+    bool string = (first == 'r' && (second == 0 || second == 'f')) || (first == 'u' && second == 0) ||
+                  (first == 'f' && second == 'r');
+    if (!bytes && !(string && allowStrings)) {
+        return start;
+    }
+    size_t end = stringEnd(prefixEnd, bytes);
+    return end > prefixEnd ? end : start;
+}
+
+// OCT_INTEGER, HEX_INTEGER, BIN_INTEGER and, if decimal, DECIMAL_INTEGER
+size_t Tokenizer::integerEnd(size_t start, bool decimal) const {
+    size_t n = text.size();
+    size_t end = start;
+    if (text[start] == '0' && start + 2 < n) {
+        char32_t base = text[start + 1] | 0x20;
+        size_t i = start + 2;
+        if (base == 'x') {
+            while (i < n && isHexDigit(text[i])) {
+                i++;
+            }
+        } else if (base == 'o') {
+            while (i < n && text[i] >= '0' && text[i] <= '7') {
+                i++;
+            }
+        } else if (base == 'b') {
+            while (i < n && (text[i] == '0' || text[i] == '1')) {
+                i++;
+            }
+        }
+        if (i > start + 2) {
+            end = i;
+        }
+    }
+    if (decimal && is(text[start], DIGIT)) {
+        // "0"+ or a digit string without leading zero
+        size_t i = start + 1;
+        while (i < n && (text[start] == '0' ? text[i] == '0' : is(text[i], DIGIT))) {
+            i++;
+        }
+        end = std::max(end, i);
+    }
+    return end;
+}
+
+// FLOAT_NUMBER and IMAG_NUMBER
+size_t Tokenizer::floatEnd(size_t start) const {
+    size_t n = text.size();
+    size_t intEnd = start;
+    while (intEnd < n && is(text[intEnd], DIGIT)) {
+        intEnd++;
+    }
+    bool hasInt = intEnd > start;
+    auto exponentEnd = [&](size_t at) {
+        if (at < n && (text[at] | 0x20) == 'e') {
+            size_t i = at + 1;
+            if (i < n && (text[i] == '+' || text[i] == '-')) {
+                i++;
+            }
+            size_t digits = i;
+            while (i < n && is(text[i], DIGIT)) {
+                i++;
+            }
+            if (i > digits) {
+                return i;
+            }
+        }
+        return start;
+    };
+
+    // POINT_FLOAT: INT_PART? FRACTION | INT_PART '.'
+    size_t pointEnd = start;
+    if (intEnd < n && text[intEnd] == '.') {
+        size_t i = intEnd + 1;
+        while (i < n && is(text[i], DIGIT)) {
+            i++;
+        }
+        if (hasInt || i > intEnd + 1) {
+            pointEnd = i;
+        }
+    }
+    // EXPONENT_FLOAT: (INT_PART | POINT_FLOAT) EXPONENT
+    size_t intExponentEnd = hasInt ? exponentEnd(intEnd) : start;
+    size_t pointExponentEnd = pointEnd > start ? exponentEnd(pointEnd) : start;
+    size_t end = std::max({pointEnd, intExponentEnd, pointExponentEnd});
+
+    // IMAG_NUMBER: (FLOAT_NUMBER | INT_PART) [jJ]
+    for (size_t candidate : {pointEnd, intExponentEnd, pointExponentEnd, intEnd}) {
+        if (candidate > start && candidate < n && (text[candidate] | 0x20) == 'j') {
+            end = std::max(end, candidate + 1);
+        }
+    }
+    return end;
+}
+
+// FORMAT_STRING_LITERAL: (STRING_ESCAPE_SEQ | ~[\\\r\n\f"{}] | '{{' | '}}')+
+size_t Tokenizer::formatTextEnd(size_t start) const {
+    size_t n = text.size();
+    size_t i = start;
+    while (i < n) {
+        char32_t c = text[i];
+        if (c == '\\') {
+            if (i + 1 >= n) {
+                break;
+            }
+            i += 2;
+            if (text[i - 1] == '\r' && i < n && text[i] == '\n') {
+                i++;
+            }
+        } else if (c == '{' || c == '}') {
+            if (i + 1 >= n || text[i + 1] != c) {
+                break;
+            }
+            i += 2;
+        } else if (c == '"' || is(c, LINE_BREAK)) {
+            break;
+        } else {
+            i++;
+        }
+    }
+    return i;
+}
+
+// LINE_JOINING: '\\' SPACES? ('\r'? '\n' | '\r' | '\f')
+size_t Tokenizer::lineJoiningEnd(size_t start) const {
+    size_t n = text.size();
+    size_t i = start + 1;
+    while (i < n && is(text[i], SPACE)) {
+        i++;
+    }
+    if (i >= n || !is(text[i], LINE_BREAK)) {
+        return start;
+    }
+    if (text[i] == '\r' && i + 1 < n && text[i + 1] == '\n') {
+        return i + 2;
+    }
+    return i + 1;
+}
+
+size_t Tokenizer::operatorEnd(size_t start, size_t& type) const {
+    size_t n = text.size();
+    char32_t c = text[start];
+    char32_t c1 = start + 1 < n ? text[start + 1] : 0;
+    char32_t c2 = start + 2 < n ? text[start + 2] : 0;
+    // One-character operator, or a two-character one when the next character is `second`
+    auto pick = [&](size_t single, char32_t second, size_t pair) {
+        if (c1 == second) {
+            type = pair;
+            return start + 2;
+        }
+        type = single;
+        return start + 1;
+    };
+    switch (c) {
+        case '.':
+            if (c1 == '.' && c2 == '.') {
+                type = Python3Lexer::ELLIPSIS;
+                return start + 3;
+            }
+            type = Python3Lexer::DOT;
+            return start + 1;
+        case '*':
+            if (c1 == '*') {
+                type = c2 == '=' ? Python3Lexer::POWER_ASSIGN : Python3Lexer::POWER;
+                return start + (c2 == '=' ? 3 : 2);
+            }
+            return pick(Python3Lexer::STAR, '=', Python3Lexer::MULT_ASSIGN);
+        case '/':
+            if (c1 == '/') {
+                type = c2 == '=' ? Python3Lexer::IDIV_ASSIGN : Python3Lexer::IDIV;
+                return start + (c2 == '=' ? 3 : 2);
+            }
+            return pick(Python3Lexer::DIV, '=', Python3Lexer::DIV_ASSIGN);
+        case '<':
+            if (c1 == '<') {
+                type = c2 == '=' ? Python3Lexer::LEFT_SHIFT_ASSIGN : Python3Lexer::LEFT_SHIFT;
+                return start + (c2 == '=' ? 3 : 2);
+            }
+            if (c1 == '>') {
+                type = Python3Lexer::NOT_EQ_1;
+                return start + 2;
+            }
+            return pick(Python3Lexer::LESS_THAN, '=', Python3Lexer::LT_EQ);
+        case '>':
+            if (c1 == '>') {
+                type = c2 == '=' ? Python3Lexer::RIGHT_SHIFT_ASSIGN : Python3Lexer::RIGHT_SHIFT;
+                return start + (c2 == '=' ? 3 : 2);
+            }
+            return pick(Python3Lexer::GREATER_THAN, '=', Python3Lexer::GT_EQ);
+        case '-':
+            if (c1 == '>') {
+                type = Python3Lexer::ARROW;
+                return start + 2;
+            }
+            return pick(Python3Lexer::MINUS, '=', Python3Lexer::SUB_ASSIGN);
+        case '+': return pick(Python3Lexer::ADD, '=', Python3Lexer::ADD_ASSIGN);
+        case '%': return pick(Python3Lexer::MOD, '=', Python3Lexer::MOD_ASSIGN);
+        case '&': return pick(Python3Lexer::AND_OP, '=', Python3Lexer::AND_ASSIGN);
+        case '|': return pick(Python3Lexer::OR_OP, '=', Python3Lexer::OR_ASSIGN);
+        case '^': return pick(Python3Lexer::XOR, '=', Python3Lexer::XOR_ASSIGN);
+        case '@': return pick(Python3Lexer::AT, '=', Python3Lexer::AT_ASSIGN);
+        case '=': return pick(Python3Lexer::ASSIGN, '=', Python3Lexer::EQUALS);
+        case '!':
+            if (c1 == '=') {
+                type = Python3Lexer::NOT_EQ_2;
+                return start + 2;
+            }
+            return start;
+        case '(': type = Python3Lexer::OPEN_PAREN; return start + 1;
+        case ')': type = Python3Lexer::CLOSE_PAREN; return start + 1;
+        case '[': type = Python3Lexer::OPEN_BRACK; return start + 1;
+        case ']': type = Python3Lexer::CLOSE_BRACK; return start + 1;
+        case '{': type = Python3Lexer::OPEN_BRACE; return start + 1;
+        case '}': type = Python3Lexer::CLOSE_BRACE; return start + 1;
+        case ',': type = Python3Lexer::COMMA; return start + 1;
+        case ':': type = Python3Lexer::COLON; return start + 1;
+        case ';': type = Python3Lexer::SEMI_COLON; return start + 1;
+        case '~': type = Python3Lexer::NOT_OP; return start + 1;
+        default: return start;
+    }
+}
+
+// A keyword's token type if the identifier is one, NAME otherwise
+size_t Tokenizer::keywordType(size_t start, size_t end) const {
+    size_t length = end - start;
+    for (const Keyword& keyword : KEYWORDS) {
+        if (keyword.length != length) {
+            continue;
+        }
+        size_t i = 0;
+        while (i < length && text[start + i] == static_cast<unsigned char>(keyword.text[i])) {
+            i++;
+        }
+        if (i == length) {
+            return keyword.type;
+        }
+    }
+    return Python3Lexer::NAME;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#ifndef PYTHON_INTERPRETER_TOKENIZER_H
+#define PYTHON_INTERPRETER_TOKENIZER_H
+
+#include "SourceStream.h"
+#include "antlr4-runtime.h"
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Tokenizer: hand-written replacement for the generated Python3Lexer.
+ *
+ * Design Philosophy:
+ * - A single forward pass over the input's code points; the first character
+ *   of a token is classified through a 128-entry table, so most tokens are
+ *   decided without looking at any other rule
+ * - Implements antlr4::TokenSource, so CommonTokenStream and Python3Parser
+ *   consume it exactly as they consume Python3Lexer
+ * - Produces the same token stream as Python3Lexer, token for token: type,
+ *   start/stop index, line, column and text, including the quirks of the
+ *   grammar's actions (a NEWLINE token spans the last characters of its
+ *   match, DEDENT tokens carry the text "DEDENT", the NEWLINE/DEDENT/EOF
+ *   tokens added at end of input are only emitted if the last line is
+ *   indented and not followed by blank or comment lines)
+ * - Python3Lexer stays the reference: `code --antlr-lexer` uses it, and
+ *   `code --dump-tokens` prints the stream of either one for diffing
+ *   (testcases/mode_diff.py "--dump-tokens" "--dump-tokens --antlr-lexer"
+ *   does that for every test case)
+ *
+ * Matching follows ANTLR's rules: the longest match wins, and between matches
+ * of equal length the rule defined first in Python3Lexer.g4, which is the one
+ * with the smaller token type. Inside the text part of an f-string (format
+ * mode without an open {}) only the rules whose predicates hold there are
+ * candidates: FORMAT_STRING_LITERAL, bytes literals, non-decimal numbers,
+ * operators, QUOTATION and the skipped rules.
+ *
+ * The code points come straight from a SourceStream's buffer; any other
+ * CharStream is decoded into a copy first.
+ *
+ * Identifiers are ASCII-table driven; for other code points the ID_START and
+ * ID_CONTINUE sets are read from Python3Lexer's ATN the first time they are
+ * needed, so non-ASCII names are classified exactly as the grammar does.
+ */
+class Tokenizer : public antlr4::TokenSource {
+public:
+    explicit Tokenizer(antlr4::CharStream* input);
+
+    std::unique_ptr<antlr4::Token> nextToken() override;
+    size_t getLine() const override;
+    size_t getCharPositionInLine() override;
+    antlr4::CharStream* getInputStream() override;
+    std::string getSourceName() override;
+    antlr4::TokenFactory<antlr4::CommonToken>* getTokenFactory() override;
+
+private:
+    antlr4::CharStream* input;
+    CodePoints text;  // the input's code points; token indexes refer to these
+    std::u32string decoded;  // holds them unless the input is a SourceStream
+    size_t pos = 0;
+    size_t line = 1;
+    size_t column = 0;
+
+    std::deque<std::unique_ptr<antlr4::CommonToken>> pending;
+    std::vector<int> indents;
+    int opened = 0;       // open (, [ and {
+    int formatMode = 0;   // nesting depth of f-strings
+    bool exprMode = false;  // inside the {} of the innermost f-string
+
+    // Matches one token starting at pos and queues what it emits, which is
+    // nothing for skipped input
+    void scanToken();
+    void scanFormatText();
+    // NEWLINE's action for the line break matched from start to pos
+    void newline(size_t start);
+
+    // Moves pos to end, counting lines the way LexerATNSimulator does
+    void advance(size_t end);
+    void emit(size_t type, size_t start, size_t stop, size_t tokenLine, size_t tokenColumn);
+    // Emits the token matched from pos to end and runs its action
+    void emitMatch(size_t type, size_t end);
+    // Emits a token placed like Python3Lexer::make_CommonToken: it ends at
+    // the current position and is `length` characters long
+    void emitTrailing(size_t type, size_t length);
+
+    // End of each kind of match starting at `start`; `start` if none
+    size_t identifierEnd(size_t start) const;
+    size_t stringEnd(size_t start, bool bytes) const;
+    size_t prefixedStringEnd(size_t start, size_t prefixEnd, bool allowStrings) const;
+    size_t integerEnd(size_t start, bool decimal) const;
+    size_t floatEnd(size_t start) const;
+    size_t formatTextEnd(size_t start) const;
+    size_t lineJoiningEnd(size_t start) const;
+    size_t operatorEnd(size_t start, size_t& type) const;
+    size_t keywordType(size_t start, size_t end) const;
+};
+
+#endif // PYTHON_INTERPRETER_TOKENIZER_H
@@ -0,0 +1,878 @@
+#include "TreeBuilder.h"
+#include "Varint.h"
+#include <algorithm>
+
+using antlr4::ParserRuleContext;
+using antlr4::Token;
+using P = Python3Parser;
+
+namespace {
+
+bool isCompOp(size_t type) {
+    switch (type) {
+        case P::LESS_THAN:
+        case P::GREATER_THAN:
+        case P::EQUALS:
+        case P::GT_EQ:
+        case P::LT_EQ:
+        case P::NOT_EQ_2:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// An arith_expr, term, factor or power that applies an operator
+bool isOperatorNode(size_t rule, size_t children) {
+    return children > 1 && (rule == P::RuleArith_expr || rule == P::RuleTerm ||
+                            rule == P::RuleFactor || rule == P::RulePower);
+}
+
+constexpr size_t RULE_COUNT = P::RuleArgument + 1;
+constexpr size_t NO_TOKEN = static_cast<size_t>(-1);
+
+// The rules a bare operand is wrapped in, each the only child of the one
+// before it; save() leaves such links out and rebuild() puts them back
+constexpr size_t OPERAND_CHAIN[] = {
+    P::RuleTest, P::RuleOr_test, P::RuleAnd_test, P::RuleNot_test, P::RuleComparison, P::RuleArith_expr,
+    P::RuleTerm, P::RuleFactor, P::RulePower, P::RuleAtom_expr, P::RuleAtom,
+};
+constexpr size_t CHAIN_LENGTH = sizeof(OPERAND_CHAIN) / sizeof(OPERAND_CHAIN[0]);
+
+// Position of a rule in OPERAND_CHAIN; 0 for any other rule, which has no
+// links above it
+size_t chainPosition(size_t rule) {
+    for (size_t i = 1; i < CHAIN_LENGTH; i++) {
+        if (OPERAND_CHAIN[i] == rule) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// A rule whose only child is the next rule of OPERAND_CHAIN
+bool isChainLink(ParserRuleContext* rule) {
+    if (rule->children.size() != 1 || rule->children[0]->getTreeType() != antlr4::tree::ParseTreeType::RULE) {
+        return false;
+    }
+    size_t child = static_cast<ParserRuleContext*>(rule->children[0])->getRuleIndex();
+    size_t link = chainPosition(child);
+    return link > 0 && OPERAND_CHAIN[link - 1] == rule->getRuleIndex();
+}
+
+}
+
+TreeBuilder::TreeBuilder(antlr4::CommonTokenStream& stream) : tokens(stream.getTokens()) {}
+
+TreeBuilder::TreeBuilder(std::vector<Token*> tokens) : tokens(std::move(tokens)) {}
+
+TreeBuilder::~TreeBuilder() {
+    for (size_t i = nodes.size(); i-- > 0;) {
+        nodes[i]->~ParseTree();
+    }
+}
+
+P::File_inputContext* TreeBuilder::parse() {
+    if (tokens.empty() || tokens.back()->getType() != Token::EOF) {
+        return nullptr;
+    }
+    try {
+        P::File_inputContext* ctx = fileInput();
+        outermostFirst();
+        return ctx;
+    } catch (const SyntaxError&) {
+        return nullptr;
+    }
+}
+
+P::StmtContext* TreeBuilder::parseStatement() {
+    if (tokens.empty() || tokens.back()->getType() != Token::EOF) {
+        return nullptr;
+    }
+    try {
+        P::StmtContext* ctx = stmt(nullptr);
+        outermostFirst();
+        return la() == Token::EOF ? ctx : nullptr;
+    } catch (const SyntaxError&) {
+        return nullptr;
+    }
+}
+
+std::vector<ParserRuleContext*> TreeBuilder::findOperatorNodes(antlr4::tree::ParseTree* tree) {
+    std::vector<ParserRuleContext*> found;
+    std::vector<antlr4::tree::ParseTree*> stack{tree};
+    while (!stack.empty()) {
+        antlr4::tree::ParseTree* node = stack.back();
+        stack.pop_back();
+        if (node->getTreeType() == antlr4::tree::ParseTreeType::RULE) {
+            auto rule = static_cast<ParserRuleContext*>(node);
+            if (isOperatorNode(rule->getRuleIndex(), rule->children.size())) {
+                found.push_back(rule);
+            }
+            stack.insert(stack.end(), rule->children.begin(), rule->children.end());
+        }
+    }
+    return found;
+}
+
+// The operators were noted as their nodes were finished, inner ones first
+void TreeBuilder::outermostFirst() {
+    std::reverse(operators.begin(), operators.end());
+}
+
+size_t TreeBuilder::save(antlr4::tree::ParseTree* tree, std::vector<uint8_t>& records,
+                         std::unordered_map<const antlr4::tree::ParseTree*, size_t>& positions) {
+    // Follows the tokens as parse() took them, checking each token, start and
+    // stop is where rebuild() will put it
+    size_t index = 0;
+    bool matchedEOF = false;
+    auto isToken = [](Token* token, size_t expected) {
+        return token ? token->getTokenIndex() == expected : expected == NO_TOKEN;
+    };
+    size_t position = 0;
+    size_t implied = 0;  // links above the next rule that are left out
+    // The rules whose children are being saved, with the next child
+    std::vector<std::pair<ParserRuleContext*, size_t>> open;
+    antlr4::tree::ParseTree* node = tree;
+    for (;;) {
+        if (!positions.empty()) {
+            auto wanted = positions.find(node);
+            if (wanted != positions.end()) {
+                wanted->second = position;
+            }
+        }
+        position++;
+        if (node->getTreeType() == antlr4::tree::ParseTreeType::RULE) {
+            auto rule = static_cast<ParserRuleContext*>(node);
+            size_t ruleIndex = rule->getRuleIndex();
+            if (ruleIndex >= RULE_COUNT || !isToken(rule->start, index)) {
+                return 0;
+            }
+            if (isChainLink(rule)) {
+                implied++;
+            } else {
+                appendVarint(records, 1 + (rule->children.size() * RULE_COUNT + ruleIndex) * CHAIN_LENGTH + implied);
+                implied = 0;
+            }
+            open.emplace_back(rule, 0);
+        } else if (node->getTreeType() == antlr4::tree::ParseTreeType::TERMINAL) {
+            Token* token = static_cast<antlr4::tree::TerminalNode*>(node)->getSymbol();
+            if (!isToken(token, index)) {
+                return 0;
+            }
+            if (token->getType() == Token::EOF) {
+                matchedEOF = true;
+            } else {
+                index++;
+            }
+            records.push_back(0);
+        } else {
+            return 0;
+        }
+        // The next node: the first child not yet saved of the innermost rule
+        // that has one, after checking the stop of each rule finished
+        node = nullptr;
+        while (!open.empty()) {
+            auto& [rule, next] = open.back();
+            if (next < rule->children.size()) {
+                node = rule->children[next++];
+                break;
+            }
+            if (!isToken(rule->stop, matchedEOF ? index : index > 0 ? index - 1 : NO_TOKEN)) {
+                return 0;
+            }
+            open.pop_back();
+        }
+        if (!node) {
+            return position;
+        }
+    }
+}
+
+P::File_inputContext* TreeBuilder::rebuild(const uint8_t* data, size_t size, size_t nodeCount) {
+    VarintReader records(data, size);
+    nodes.reserve(std::min(nodeCount, size * (CHAIN_LENGTH + 1)));
+    // The rules whose children are still being read, with how many are left
+    std::vector<std::pair<ParserRuleContext*, uint64_t>> open;
+    ParserRuleContext* root = nullptr;
+    while (!records.atEnd()) {
+        if ((root && open.empty()) || index >= tokens.size()) {
+            return nullptr;
+        }
+        ParserRuleContext* parent = open.empty() ? nullptr : open.back().first;
+        if (parent) {
+            open.back().second--;
+        }
+        uint64_t record = records.read();
+        if (records.failed()) {
+            return nullptr;
+        }
+        if (record == 0) {
+            if (!parent) {
+                return nullptr;
+            }
+            matchedEOF = matchedEOF || la() == Token::EOF;
+            consume(parent);
+        } else {
+            record--;
+            size_t implied = record % CHAIN_LENGTH;
+            record /= CHAIN_LENGTH;
+            size_t rule = record % RULE_COUNT;
+            uint64_t children = record / RULE_COUNT;
+            size_t link = chainPosition(rule);
+            // Only the root has no parent, and every child takes a byte at least
+            if (implied > link || children > size || (!parent && (rule != P::RuleFile_input || implied))) {
+                return nullptr;
+            }
+            for (link -= implied; link < chainPosition(rule); link++) {
+                parent = attachRule(OPERAND_CHAIN[link], parent);
+                parent->start = tokens[index];
+                open.emplace_back(parent, 0);
+            }
+            ParserRuleContext* ctx = attachRule(rule, parent);
+            if (!ctx) {
+                return nullptr;
+            }
+            ctx->start = tokens[index];
+            root = root ? root : ctx;
+            ctx->children.reserve(children);
+            if (isOperatorNode(rule, children)) {
+                operators.push_back(ctx);
+            }
+            open.emplace_back(ctx, children);
+        }
+        while (!open.empty() && open.back().second == 0) {
+            exit(open.back().first);
+            open.pop_back();
+        }
+    }
+    if (!root || !open.empty() || records.failed()) {
+        return nullptr;
+    }
+    return static_cast<P::File_inputContext*>(root);
+}
+
+ParserRuleContext* TreeBuilder::attachRule(size_t rule, ParserRuleContext* parent) {
+    switch (rule) {
+        case P::RuleFile_input:
+            return attach<P::File_inputContext>(parent);
+        case P::RuleFuncdef:
+            return attach<P::FuncdefContext>(parent);
+        case P::RuleParameters:
+            return attach<P::ParametersContext>(parent);
+        case P::RuleTypedargslist:
+            return attach<P::TypedargslistContext>(parent);
+        case P::RuleTfpdef:
+            return attach<P::TfpdefContext>(parent);
+        case P::RuleStmt:
+            return attach<P::StmtContext>(parent);
+        case P::RuleSimple_stmt:
+            return attach<P::Simple_stmtContext>(parent);
+        case P::RuleSmall_stmt:
+            return attach<P::Small_stmtContext>(parent);
+        case P::RuleExpr_stmt:
+            return attach<P::Expr_stmtContext>(parent);
+        case P::RuleAugassign:
+            return attach<P::AugassignContext>(parent);
+        case P::RuleFlow_stmt:
+            return attach<P::Flow_stmtContext>(parent);
+        case P::RuleBreak_stmt:
+            return attach<P::Break_stmtContext>(parent);
+        case P::RuleContinue_stmt:
+            return attach<P::Continue_stmtContext>(parent);
+        case P::RuleReturn_stmt:
+            return attach<P::Return_stmtContext>(parent);
+        case P::RuleGlobal_stmt:
+            return attach<P::Global_stmtContext>(parent);
+        case P::RuleCompound_stmt:
+            return attach<P::Compound_stmtContext>(parent);
+        case P::RuleIf_stmt:
+            return attach<P::If_stmtContext>(parent);
+        case P::RuleWhile_stmt:
+            return attach<P::While_stmtContext>(parent);
+        case P::RuleSuite:
+            return attach<P::SuiteContext>(parent);
+        case P::RuleTest:
+            return attach<P::TestContext>(parent);
+        case P::RuleOr_test:
+            return attach<P::Or_testContext>(parent);
+        case P::RuleAnd_test:
+            return attach<P::And_testContext>(parent);
+        case P::RuleNot_test:
+            return attach<P::Not_testContext>(parent);
+        case P::RuleComparison:
+            return attach<P::ComparisonContext>(parent);
+        case P::RuleComp_op:
+            return attach<P::Comp_opContext>(parent);
+        case P::RuleArith_expr:
+            return attach<P::Arith_exprContext>(parent);
+        case P::RuleAddorsub_op:
+            return attach<P::Addorsub_opContext>(parent);
+        case P::RuleTerm:
+            return attach<P::TermContext>(parent);
+        case P::RuleMuldivmod_op:
+            return attach<P::Muldivmod_opContext>(parent);
+        case P::RuleFactor:
+            return attach<P::FactorContext>(parent);
+        case P::RulePower:
+            return attach<P::PowerContext>(parent);
+        case P::RuleAtom_expr:
+            return attach<P::Atom_exprContext>(parent);
+        case P::RuleTrailer:
+            return attach<P::TrailerContext>(parent);
+        case P::RuleAtom:
+            return attach<P::AtomContext>(parent);
+        case P::RuleFormat_string:
+            return attach<P::Format_stringContext>(parent);
+        case P::RuleTestlist:
+            return attach<P::TestlistContext>(parent);
+        case P::RuleArglist:
+            return attach<P::ArglistContext>(parent);
+        case P::RuleArgument:
+            return attach<P::ArgumentContext>(parent);
+        default:
+            return nullptr;
+    }
+}
+
+void* TreeBuilder::allocate(size_t size) {
+    size = (size + 15) & ~(size_t)15;
+    if (size > left) {
+        blocks.emplace_back(new char[BLOCK_SIZE]);
+        next = blocks.back().get();
+        left = BLOCK_SIZE;
+    }
+    void* p = next;
+    next += size;
+    left -= size;
+    return p;
+}
+
+// Parser::exitRule: the stop token is the last one consumed, or EOF once
+// EOF has been matched
+void TreeBuilder::exit(ParserRuleContext* ctx) {
+    if (matchedEOF) {
+        ctx->stop = tokens[index];
+    } else {
+        ctx->stop = index > 0 ? tokens[index - 1] : nullptr;
+    }
+}
+
+// Type of the next token; consuming EOF does not move past it
+size_t TreeBuilder::la() const {
+    return tokens[index]->getType();
+}
+
+void TreeBuilder::consume(ParserRuleContext* ctx) {
+    Token* token = tokens[index];
+    if (token->getType() != Token::EOF) {
+        index++;
+    }
+    ctx->addChild(create<antlr4::tree::TerminalNodeImpl>(token));
+}
+
+void TreeBuilder::match(ParserRuleContext* ctx, size_t type) {
+    if (la() != type) {
+        throw SyntaxError();
+    }
+    if (type == Token::EOF) {
+        matchedEOF = true;
+    }
+    consume(ctx);
+}
+
+bool TreeBuilder::startsTest(size_t type) {
+    switch (type) {
+        case P::STRING:
+        case P::NUMBER:
+        case P::NOT:
+        case P::NONE:
+        case P::TRUE:
+        case P::FALSE:
+        case P::NAME:
+        case P::OPEN_PAREN:
+        case P::OPEN_BRACK:
+        case P::ADD:
+        case P::MINUS:
+        case P::FORMAT_QUOTATION:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool TreeBuilder::startsStmt(size_t type) {
+    switch (type) {
+        case P::DEF:
+        case P::RETURN:
+        case P::IF:
+        case P::WHILE:
+        case P::CONTINUE:
+        case P::BREAK:
+        case P::GLOBAL:
+            return true;
+        default:
+            return startsTest(type);
+    }
+}
+
+// file_input: (NEWLINE | stmt)* EOF
+P::File_inputContext* TreeBuilder::fileInput() {
+    auto ctx = enter<P::File_inputContext>(nullptr);
+    for (;;) {
+        if (la() == P::NEWLINE) {
+            consume(ctx);
+        } else if (startsStmt(la())) {
+            stmt(ctx);
+        } else {
+            break;
+        }
+    }
+    match(ctx, Token::EOF);
+    exit(ctx);
+    return ctx;
+}
+
+// funcdef: 'def' NAME parameters ':' suite
+void TreeBuilder::funcdef(ParserRuleContext* parent) {
+    auto ctx = enter<P::FuncdefContext>(parent);
+    match(ctx, P::DEF);
+    match(ctx, P::NAME);
+    parameters(ctx);
+    match(ctx, P::COLON);
+    suite(ctx);
+    exit(ctx);
+}
+
+// parameters: '(' typedargslist? ')'
+void TreeBuilder::parameters(ParserRuleContext* parent) {
+    auto ctx = enter<P::ParametersContext>(parent);
+    match(ctx, P::OPEN_PAREN);
+    if (la() == P::NAME) {
+        typedargslist(ctx);
+    }
+    match(ctx, P::CLOSE_PAREN);
+    exit(ctx);
+}
+
+// typedargslist: tfpdef ('=' test)? (',' tfpdef ('=' test)?)*
+void TreeBuilder::typedargslist(ParserRuleContext* parent) {
+    auto ctx = enter<P::TypedargslistContext>(parent);
+    for (;;) {
+        tfpdef(ctx);
+        if (la() == P::ASSIGN) {
+            consume(ctx);
+            test(ctx);
+        }
+        if (la() != P::COMMA) {
+            break;
+        }
+        consume(ctx);
+    }
+    exit(ctx);
+}
+
+// tfpdef: NAME
+void TreeBuilder::tfpdef(ParserRuleContext* parent) {
+    auto ctx = enter<P::TfpdefContext>(parent);
+    match(ctx, P::NAME);
+    exit(ctx);
+}
+
+// stmt: simple_stmt | compound_stmt
+P::StmtContext* TreeBuilder::stmt(ParserRuleContext* parent) {
+    auto ctx = enter<P::StmtContext>(parent);
+    switch (la()) {
+        case P::IF:
+        case P::WHILE:
+        case P::DEF:
+            compoundStmt(ctx);
+            break;
+        default:
+            simpleStmt(ctx);
+            break;
+    }
+    exit(ctx);
+    return ctx;
+}
+
+// simple_stmt: small_stmt NEWLINE
+void TreeBuilder::simpleStmt(ParserRuleContext* parent) {
+    auto ctx = enter<P::Simple_stmtContext>(parent);
+    smallStmt(ctx);
+    match(ctx, P::NEWLINE);
+    exit(ctx);
+}
+
+// small_stmt: expr_stmt | flow_stmt | global_stmt
+void TreeBuilder::smallStmt(ParserRuleContext* parent) {
+    auto ctx = enter<P::Small_stmtContext>(parent);
+    switch (la()) {
+        case P::BREAK:
+        case P::CONTINUE:
+        case P::RETURN:
+            flowStmt(ctx);
+            break;
+        case P::GLOBAL:
+            globalStmt(ctx);
+            break;
+        default:
+            exprStmt(ctx);
+            break;
+    }
+    exit(ctx);
+}
+
+// expr_stmt: testlist ((augassign testlist) | ('=' testlist)*)
+void TreeBuilder::exprStmt(ParserRuleContext* parent) {
+    auto ctx = enter<P::Expr_stmtContext>(parent);
+    testlist(ctx);
+    switch (la()) {
+        case P::ADD_ASSIGN:
+        case P::SUB_ASSIGN:
+        case P::MULT_ASSIGN:
+        case P::DIV_ASSIGN:
+        case P::IDIV_ASSIGN:
+        case P::MOD_ASSIGN:
+        case P::POWER_ASSIGN:
+            operatorRule<P::AugassignContext>(ctx);
+            testlist(ctx);
+            break;
+        default:
+            while (la() == P::ASSIGN) {
+                consume(ctx);
+                testlist(ctx);
+            }
+            break;
+    }
+    exit(ctx);
+}
+
+// flow_stmt: break_stmt | continue_stmt | return_stmt
+void TreeBuilder::flowStmt(ParserRuleContext* parent) {
+    auto ctx = enter<P::Flow_stmtContext>(parent);
+    switch (la()) {
+        case P::BREAK:
+            operatorRule<P::Break_stmtContext>(ctx);
+            break;
+        case P::CONTINUE:
+            operatorRule<P::Continue_stmtContext>(ctx);
+            break;
+        default:
+            returnStmt(ctx);
+            break;
+    }
+    exit(ctx);
+}
+
+// return_stmt: 'return' (testlist)?
+void TreeBuilder::returnStmt(ParserRuleContext* parent) {
+    auto ctx = enter<P::Return_stmtContext>(parent);
+    match(ctx, P::RETURN);
+    if (startsTest(la())) {
+        testlist(ctx);
+    }
+    exit(ctx);
+}
+
+// global_stmt: GLOBAL NAME (',' NAME)*
+void TreeBuilder::globalStmt(ParserRuleContext* parent) {
+    auto ctx = enter<P::Global_stmtContext>(parent);
+    match(ctx, P::GLOBAL);
+    match(ctx, P::NAME);
+    while (la() == P::COMMA) {
+        consume(ctx);
+        match(ctx, P::NAME);
+    }
+    exit(ctx);
+}
+
+// compound_stmt: if_stmt | while_stmt | funcdef
+void TreeBuilder::compoundStmt(ParserRuleContext* parent) {
+    auto ctx = enter<P::Compound_stmtContext>(parent);
+    switch (la()) {
+        case P::IF:
+            ifStmt(ctx);
+            break;
+        case P::WHILE:
+            whileStmt(ctx);
+            break;
+        default:
+            funcdef(ctx);
+            break;
+    }
+    exit(ctx);
+}
+
+// if_stmt: 'if' test ':' suite ('elif' test ':' suite)* ('else' ':' suite)?
+void TreeBuilder::ifStmt(ParserRuleContext* parent) {
+    auto ctx = enter<P::If_stmtContext>(parent);
+    match(ctx, P::IF);
+    test(ctx);
+    match(ctx, P::COLON);
+    suite(ctx);
+    while (la() == P::ELIF) {
+        consume(ctx);
+        test(ctx);
+        match(ctx, P::COLON);
+        suite(ctx);
+    }
+    if (la() == P::ELSE) {
+        consume(ctx);
+        match(ctx, P::COLON);
+        suite(ctx);
+    }
+    exit(ctx);
+}
+
+// while_stmt: 'while' test ':' suite
+void TreeBuilder::whileStmt(ParserRuleContext* parent) {
+    auto ctx = enter<P::While_stmtContext>(parent);
+    match(ctx, P::WHILE);
+    test(ctx);
+    match(ctx, P::COLON);
+    suite(ctx);
+    exit(ctx);
+}
+
+// suite: simple_stmt | NEWLINE INDENT stmt+ DEDENT
+void TreeBuilder::suite(ParserRuleContext* parent) {
+    auto ctx = enter<P::SuiteContext>(parent);
+    if (la() == P::NEWLINE) {
+        consume(ctx);
+        match(ctx, P::INDENT);
+        do {
+            stmt(ctx);
+        } while (startsStmt(la()));
+        match(ctx, P::DEDENT);
+    } else {
+        simpleStmt(ctx);
+    }
+    exit(ctx);
+}
+
+// test: or_test
+void TreeBuilder::test(ParserRuleContext* parent) {
+    auto ctx = enter<P::TestContext>(parent);
+    orTest(ctx);
+    exit(ctx);
+}
+
+// or_test: and_test ('or' and_test)*
+void TreeBuilder::orTest(ParserRuleContext* parent) {
+    auto ctx = enter<P::Or_testContext>(parent);
+    andTest(ctx);
+    while (la() == P::OR) {
+        consume(ctx);
+        andTest(ctx);
+    }
+    exit(ctx);
+}
+
+// and_test: not_test ('and' not_test)*
+void TreeBuilder::andTest(ParserRuleContext* parent) {
+    auto ctx = enter<P::And_testContext>(parent);
+    notTest(ctx);
+    while (la() == P::AND) {
+        consume(ctx);
+        notTest(ctx);
+    }
+    exit(ctx);
+}
+
+// not_test: 'not' not_test | comparison
+void TreeBuilder::notTest(ParserRuleContext* parent) {
+    auto ctx = enter<P::Not_testContext>(parent);
+    if (la() == P::NOT) {
+        consume(ctx);
+        notTest(ctx);
+    } else {
+        comparison(ctx);
+    }
+    exit(ctx);
+}
+
+// comparison: arith_expr (comp_op arith_expr)*
+void TreeBuilder::comparison(ParserRuleContext* parent) {
+    auto ctx = enter<P::ComparisonContext>(parent);
+    arithExpr(ctx);
+    while (isCompOp(la())) {
+        operatorRule<P::Comp_opContext>(ctx);
+        arithExpr(ctx);
+    }
+    exit(ctx);
+}
+
+// arith_expr: term (addorsub_op term)*
+void TreeBuilder::arithExpr(ParserRuleContext* parent) {
+    auto ctx = enter<P::Arith_exprContext>(parent);
+    term(ctx);
+    while (la() == P::ADD || la() == P::MINUS) {
+        operatorRule<P::Addorsub_opContext>(ctx);
+        term(ctx);
+    }
+    if (ctx->children.size() > 1) {
+        operators.push_back(ctx);
+    }
+    exit(ctx);
+}
+
+// term: factor (muldivmod_op factor)*
+void TreeBuilder::term(ParserRuleContext* parent) {
+    auto ctx = enter<P::TermContext>(parent);
+    factor(ctx);
+    while (la() == P::STAR || la() == P::DIV || la() == P::IDIV || la() == P::MOD) {
+        operatorRule<P::Muldivmod_opContext>(ctx);
+        factor(ctx);
+    }
+    if (ctx->children.size() > 1) {
+        operators.push_back(ctx);
+    }
+    exit(ctx);
+}
+
+// factor: ('+'|'-') factor | power
+void TreeBuilder::factor(ParserRuleContext* parent) {
+    auto ctx = enter<P::FactorContext>(parent);
+    if (la() == P::ADD || la() == P::MINUS) {
+        consume(ctx);
+        factor(ctx);
+        operators.push_back(ctx);
+    } else {
+        power(ctx);
+    }
+    exit(ctx);
+}
+
+// power: atom_expr (POWER factor)?
+void TreeBuilder::power(ParserRuleContext* parent) {
+    auto ctx = enter<P::PowerContext>(parent);
+    atomExpr(ctx);
+    if (la() == P::POWER) {
+        consume(ctx);
+        factor(ctx);
+        operators.push_back(ctx);
+    }
+    exit(ctx);
+}
+
+// atom_expr: atom trailer*
+void TreeBuilder::atomExpr(ParserRuleContext* parent) {
+    auto ctx = enter<P::Atom_exprContext>(parent);
+    atom(ctx);
+    while (la() == P::OPEN_PAREN || la() == P::OPEN_BRACK) {
+        trailer(ctx);
+    }
+    exit(ctx);
+}
+
+// trailer: '(' (arglist)? ')' | '[' test ']'
+void TreeBuilder::trailer(ParserRuleContext* parent) {
+    auto ctx = enter<P::TrailerContext>(parent);
+    if (la() == P::OPEN_PAREN) {
+        consume(ctx);
+        if (startsTest(la())) {
+            arglist(ctx);
+        }
+        match(ctx, P::CLOSE_PAREN);
+    } else {
+        consume(ctx);
+        test(ctx);
+        match(ctx, P::CLOSE_BRACK);
+    }
+    exit(ctx);
+}
+
+// atom: NAME | NUMBER | STRING+ | 'None' | 'True' | 'False' | '(' testlist? ')'
+//     | '[' testlist? ']' | format_string
+void TreeBuilder::atom(ParserRuleContext* parent) {
+    auto ctx = enter<P::AtomContext>(parent);
+    switch (la()) {
+        case P::NAME:
+        case P::NUMBER:
+        case P::NONE:
+        case P::TRUE:
+        case P::FALSE:
+            consume(ctx);
+            break;
+        case P::STRING:
+            do {
+                consume(ctx);
+            } while (la() == P::STRING);
+            break;
+        case P::OPEN_PAREN:
+        case P::OPEN_BRACK: {
+            size_t close = la() == P::OPEN_PAREN ? P::CLOSE_PAREN : P::CLOSE_BRACK;
+            consume(ctx);
+            if (startsTest(la())) {
+                testlist(ctx);
+            }
+            match(ctx, close);
+            break;
+        }
+        case P::FORMAT_QUOTATION:
+            formatString(ctx);
+            break;
+        default:
+            throw SyntaxError();
+    }
+    exit(ctx);
+}
+
+// format_string: FORMAT_QUOTATION (FORMAT_STRING_LITERAL | '{' testlist '}')* QUOTATION
+void TreeBuilder::formatString(ParserRuleContext* parent) {
+    auto ctx = enter<P::Format_stringContext>(parent);
+    consume(ctx);
+    for (;;) {
+        if (la() == P::FORMAT_STRING_LITERAL) {
+            consume(ctx);
+        } else if (la() == P::OPEN_BRACE) {
+            consume(ctx);
+            testlist(ctx);
+            match(ctx, P::CLOSE_BRACE);
+        } else {
+            break;
+        }
+    }
+    match(ctx, P::QUOTATION);
+    exit(ctx);
+}
+
+// testlist: test (',' test)* (',')?
+void TreeBuilder::testlist(ParserRuleContext* parent) {
+    auto ctx = enter<P::TestlistContext>(parent);
+    test(ctx);
+    while (la() == P::COMMA) {
+        consume(ctx);
+        if (!startsTest(la())) {
+            break;
+        }
+        test(ctx);
+    }
+    exit(ctx);
+}
+
+// arglist: argument (',' argument)* (',')?
+void TreeBuilder::arglist(ParserRuleContext* parent) {
+    auto ctx = enter<P::ArglistContext>(parent);
+    argument(ctx);
+    while (la() == P::COMMA) {
+        consume(ctx);
+        if (!startsTest(la())) {
+            break;
+        }
+        argument(ctx);
+    }
+    exit(ctx);
+}
+
+// argument: test | test '=' test
+void TreeBuilder::argument(ParserRuleContext* parent) {
+    auto ctx = enter<P::ArgumentContext>(parent);
+    test(ctx);
+    if (la() == P::ASSIGN) {
+        consume(ctx);
+        test(ctx);
+    }
+    exit(ctx);
+}
@@ -0,0 +1,180 @@
+#pragma once
+#ifndef PYTHON_INTERPRETER_TREEBUILDER_H
+#define PYTHON_INTERPRETER_TREEBUILDER_H
+
+#include "Python3Parser.h"
+#include "antlr4-runtime.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * TreeBuilder: recursive-descent parser for Python3Parser.g4.
+ *
+ * Design Philosophy:
+ * - The grammar is LL(1) once `test ('=' test)?` and a trailing comma are
+ *   decided after the fact, so every rule is a function that switches on
+ *   the next token and never backtracks: no ATN simulation, prediction DFA,
+ *   error-strategy sync or state bookkeeping
+ * - Builds the same Python3Parser::*Context trees as the generated parser,
+ *   node for node (children, parent links, start and stop tokens), so
+ *   EvalVisitor runs on them unchanged; only invokingState, which nothing
+ *   reads, is not the generated parser's ATN state
+ * - Nodes are constructed in place in an arena of 64 KiB blocks owned by the
+ *   builder rather than allocated one by one; the tree lives as long as the
+ *   builder
+ * - At the first token that does not fit the grammar it gives up and returns
+ *   nullptr; the driver then parses with Python3Parser, which reports the
+ *   syntax error and recovers exactly as before
+ * - Python3Parser stays the reference: `code --antlr-parser` uses it, and
+ *   `code --dump-tree` prints either tree for diffing
+ *   (testcases/mode_diff.py "--dump-tree" "--dump-tree --antlr-parser"
+ *   does that for every test case)
+ * - parseStatement() parses a single statement for `code --stream`, which
+ *   hands it the tokens of one top-level statement at a time
+ * - save() flattens a tree into records and rebuild() constructs it again
+ *   from them, which is how ProgramCache stores a parsed program
+ * - Both note the arith_expr, term, factor and power nodes that apply an
+ *   operator as they build them, which is where EvalVisitor::foldConstants()
+ *   looks for constant expressions; findOperatorNodes() finds them in a tree
+ *   from Python3Parser
+ */
+class TreeBuilder {
+public:
+    // The token stream must be filled
+    explicit TreeBuilder(antlr4::CommonTokenStream& stream);
+    // The tokens of one statement, followed by an EOF token
+    explicit TreeBuilder(std::vector<antlr4::Token*> tokens);
+    ~TreeBuilder();
+    TreeBuilder(const TreeBuilder&) = delete;
+    TreeBuilder& operator=(const TreeBuilder&) = delete;
+
+    // Parses file_input; nullptr on a syntax error
+    Python3Parser::File_inputContext* parse();
+    // Parses a stmt that spans all the tokens; nullptr on a syntax error
+    Python3Parser::StmtContext* parseStatement();
+
+    // Tree records, in preorder, one varint each (see Varint.h): 0 for a
+    // token, otherwise a rule with its number of children and how many rules
+    // above it are implied links of the chain test -> or_test -> ... -> atom
+    // that a bare operand is wrapped in. Nothing else is stored: tokens are
+    // taken in order, and a rule starts at the next token and stops at the
+    // last one taken, or at EOF once EOF is taken, as parse() builds it.
+    // save() returns the number of nodes, or 0 for a tree that differs, such
+    // as one Python3Parser recovered from a syntax error. `positions` holds
+    // nodes whose preorder position is wanted; save() fills it in
+    static size_t save(antlr4::tree::ParseTree* tree, std::vector<uint8_t>& records,
+                       std::unordered_map<const antlr4::tree::ParseTree*, size_t>& positions);
+    // Constructs the file_input of `nodeCount` nodes saved in `records` over
+    // this builder's tokens; nullptr if the records are malformed
+    Python3Parser::File_inputContext* rebuild(const uint8_t* records, size_t size, size_t nodeCount);
+    // The nodes rebuild() constructed, in preorder
+    const std::vector<antlr4::tree::ParseTree*>& rebuiltNodes() const { return nodes; }
+
+    // The nodes that apply an operator in the tree parsed or rebuilt, outermost
+    // first: each is followed by the ones inside it
+    const std::vector<antlr4::ParserRuleContext*>& operatorNodes() const { return operators; }
+    // The same for any tree, by walking it
+    static std::vector<antlr4::ParserRuleContext*> findOperatorNodes(antlr4::tree::ParseTree* tree);
+
+private:
+    struct SyntaxError {};
+
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<antlr4::Token*> tokens;
+    size_t index = 0;
+    bool matchedEOF = false;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* next = nullptr;
+    size_t left = 0;
+    std::vector<antlr4::tree::ParseTree*> nodes;  // destroyed in reverse order
+    std::vector<antlr4::ParserRuleContext*> operators;
+
+    void* allocate(size_t size);
+
+    template <typename T, typename Arg>
+    T* create(Arg arg) {
+        T* node = new (allocate(sizeof(T))) T(arg);
+        nodes.push_back(node);
+        return node;
+    }
+
+    // A new context attached to its parent
+    template <typename T>
+    T* attach(antlr4::ParserRuleContext* parent) {
+        T* node = new (allocate(sizeof(T))) T(parent, parent ? 0 : INVALID_INDEX);
+        nodes.push_back(node);
+        if (parent) {
+            parent->addChild(node);
+        }
+        return node;
+    }
+
+    // Parser::enterRule: a new context for the rule, starting at the next token
+    template <typename T>
+    T* enter(antlr4::ParserRuleContext* parent) {
+        T* node = attach<T>(parent);
+        node->start = tokens[index];
+        return node;
+    }
+
+    // attach() for a rule index; nullptr if there is no such rule
+    antlr4::ParserRuleContext* attachRule(size_t rule, antlr4::ParserRuleContext* parent);
+
+    void exit(antlr4::ParserRuleContext* ctx);
+    void outermostFirst();
+
+    size_t la() const;
+    void consume(antlr4::ParserRuleContext* ctx);
+    void match(antlr4::ParserRuleContext* ctx, size_t type);
+
+    static bool startsTest(size_t type);
+    static bool startsStmt(size_t type);
+
+    Python3Parser::File_inputContext* fileInput();
+    void funcdef(antlr4::ParserRuleContext* parent);
+    void parameters(antlr4::ParserRuleContext* parent);
+    void typedargslist(antlr4::ParserRuleContext* parent);
+    void tfpdef(antlr4::ParserRuleContext* parent);
+    Python3Parser::StmtContext* stmt(antlr4::ParserRuleContext* parent);
+    void simpleStmt(antlr4::ParserRuleContext* parent);
+    void smallStmt(antlr4::ParserRuleContext* parent);
+    void exprStmt(antlr4::ParserRuleContext* parent);
+    void flowStmt(antlr4::ParserRuleContext* parent);
+    void returnStmt(antlr4::ParserRuleContext* parent);
+    void globalStmt(antlr4::ParserRuleContext* parent);
+    void compoundStmt(antlr4::ParserRuleContext* parent);
+    void ifStmt(antlr4::ParserRuleContext* parent);
+    void whileStmt(antlr4::ParserRuleContext* parent);
+    void suite(antlr4::ParserRuleContext* parent);
+    void test(antlr4::ParserRuleContext* parent);
+    void orTest(antlr4::ParserRuleContext* parent);
+    void andTest(antlr4::ParserRuleContext* parent);
+    void notTest(antlr4::ParserRuleContext* parent);
+    void comparison(antlr4::ParserRuleContext* parent);
+    void arithExpr(antlr4::ParserRuleContext* parent);
+    void term(antlr4::ParserRuleContext* parent);
+    void factor(antlr4::ParserRuleContext* parent);
+    void power(antlr4::ParserRuleContext* parent);
+    void atomExpr(antlr4::ParserRuleContext* parent);
+    void trailer(antlr4::ParserRuleContext* parent);
+    void atom(antlr4::ParserRuleContext* parent);
+    void formatString(antlr4::ParserRuleContext* parent);
+    void testlist(antlr4::ParserRuleContext* parent);
+    void arglist(antlr4::ParserRuleContext* parent);
+    void argument(antlr4::ParserRuleContext* parent);
+    // A rule that is a single operator token, already checked by the caller
+    template <typename T>
+    void operatorRule(antlr4::ParserRuleContext* parent) {
+        T* ctx = enter<T>(parent);
+        consume(ctx);
+        exit(ctx);
+    }
+};
+
+#endif // PYTHON_INTERPRETER_TREEBUILDER_H
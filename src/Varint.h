@@ -0,0 +1,74 @@
+#pragma once
+#ifndef PYTHON_INTERPRETER_VARINT_H
+#define PYTHON_INTERPRETER_VARINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Varints: unsigned integers in seven-bit groups, low group first, each byte
+ * but the last with its high bit set (LEB128).
+ *
+ * Design Philosophy:
+ * - The format of ProgramCache files, whose fields are nearly all small: a
+ *   token type, the gap to the previous token, a tree record
+ * - A signed value is zigzag-encoded first, so small negative numbers stay
+ *   short too
+ * - VarintReader never reads past its end: a truncated or overlong varint
+ *   sets failed() and reads as 0, so a damaged file is a miss, not a crash
+ */
+inline void appendVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+class VarintReader {
+public:
+    VarintReader(const uint8_t* data, size_t size) : next(data), end(data + size) {}
+
+    uint64_t read() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; next != end && shift < 64; shift += 7) {
+            uint8_t byte = *next++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) {
+                return value;
+            }
+        }
+        bad = true;
+        return 0;
+    }
+
+    // The next `size` bytes, or nullptr if fewer are left
+    const uint8_t* bytes(size_t size) {
+        if (static_cast<size_t>(end - next) < size) {
+            bad = true;
+            return nullptr;
+        }
+        const uint8_t* start = next;
+        next += size;
+        return start;
+    }
+
+    bool atEnd() const { return next == end; }
+    bool failed() const { return bad; }
+
+private:
+    const uint8_t* next;
+    const uint8_t* end;
+    bool bad = false;
+};
+
+#endif // PYTHON_INTERPRETER_VARINT_H
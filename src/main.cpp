@@ -1,27 +1,315 @@
 #include "Evalvisitor.h"
+#include "ProgramCache.h"
 #include "Python3Lexer.h"
 #include "Python3Parser.h"
+#include "SourceStream.h"
+#include "StatementReader.h"
+#include "Tokenizer.h"
+#include "TreeBuilder.h"
 #include "antlr4-runtime.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
 using namespace antlr4;
 
+// --startup-profile: where the time of a run goes, from process start to the
+// end of main, printed on stderr as main returns
+struct StartupProfile {
+    bool enabled = false;
+    double cpuBeforeMain = 0;  // process CPU time when main starts: loading,
+                               // relocation and static initialization
+    std::chrono::steady_clock::time_point mainStart;
+    std::chrono::steady_clock::time_point last;
+    std::vector<std::pair<const char*, double>> phases;
+
+    // Ends a phase at the current time
+    void mark(const char* phase) {
+        if (enabled) {
+            auto now = std::chrono::steady_clock::now();
+            phases.emplace_back(phase, std::chrono::duration<double, std::milli>(now - last).count());
+            last = now;
+        }
+    }
+};
+
 struct RunArgs {
     int argc;
     const char** argv;
     int result;
+    StartupProfile profile;
 };
 
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Two-stage parse: SLL prediction with a bail-out strategy first, which is
+// enough for nearly every program and much cheaper than full LL. Only on a
+// syntax error is the input re-parsed with full LL and the default recovery,
+// so error messages and the recovered tree are the same as a single LL parse.
+static tree::ParseTree* parseFileInput(Python3Parser& parser, CommonTokenStream& tokens, bool& usedFallback) {
+    auto interpreter = parser.getInterpreter<atn::ParserATNSimulator>();
+    interpreter->setPredictionMode(atn::PredictionMode::SLL);
+    parser.setErrorHandler(std::make_shared<BailErrorStrategy>());
+    parser.removeErrorListeners();
+    try {
+        usedFallback = false;
+        return parser.file_input();
+    } catch (const ParseCancellationException&) {
+        usedFallback = true;
+    }
+    
+    tokens.seek(0);
+    parser.reset();
+    parser.addErrorListener(&ConsoleErrorListener::INSTANCE);
+    parser.setErrorHandler(std::make_shared<DefaultErrorStrategy>());
+    interpreter->setPredictionMode(atn::PredictionMode::LL);
+    return parser.file_input();
+}
+
+static std::string escapeText(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '\n') {
+            escaped += "\\n";
+        } else if (c == '\r') {
+            escaped += "\\r";
+        } else if (c == '\t') {
+            escaped += "\\t";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// One line per token: type, line:column, start-stop and the text with line
+// breaks and tabs escaped; the same format as lex_bench --dump
+static void dumpTokens(CommonTokenStream& tokens) {
+    for (Token* token : tokens.getTokens()) {
+        std::cout << token->getType() << ' ' << token->getLine() << ':' << token->getCharPositionInLine() << ' '
+                  << token->getStartIndex() << '-' << token->getStopIndex() << " '" << escapeText(token->getText())
+                  << "'\n";
+    }
+}
+
+// One line per node, indented by depth: a rule's name with the indexes of its
+// start and stop tokens, or a token's index and text. A child whose parent
+// link does not point back is marked.
+static void dumpTree(tree::ParseTree* node, const std::vector<std::string>& ruleNames, size_t depth) {
+    auto tokenIndex = [](Token* token) {
+        return token ? std::to_string(token->getTokenIndex()) : std::string("null");
+    };
+    std::cout << std::string(2 * depth, ' ');
+    if (auto rule = dynamic_cast<ParserRuleContext*>(node)) {
+        std::cout << ruleNames[rule->getRuleIndex()] << ' ' << tokenIndex(rule->getStart()) << '-'
+                  << tokenIndex(rule->getStop()) << '\n';
+    } else {
+        Token* token = static_cast<tree::TerminalNode*>(node)->getSymbol();
+        std::cout << tokenIndex(token) << " '" << escapeText(token->getText()) << "'\n";
+    }
+    for (tree::ParseTree* child : node->children) {
+        if (child->parent != node) {
+            std::cout << std::string(2 * depth + 2, ' ') << "(parent link broken)\n";
+        }
+        dumpTree(child, ruleNames, depth + 1);
+    }
+}
+
+// --stream: parse and run one top-level statement at a time, so output starts
+// at once and only the trees of function definitions are kept. A syntax error
+// is reported when its statement is reached, after the ones before it ran.
+static void runStatements(TokenSource& lexer, bool antlrParser, bool timing) {
+    StatementReader reader(lexer, antlrParser);
+    EvalVisitor visitor;
+    std::vector<std::unique_ptr<StatementReader::Statement>> definitions;
+    size_t statements = 0;
+    size_t folded = 0;
+    double parseMs = 0;
+    double foldMs = 0;
+    double runMs = 0;
+    try {
+        for (;;) {
+            auto start = std::chrono::steady_clock::now();
+            auto statement = reader.next();
+            parseMs += millisecondsSince(start);
+            if (!statement) {
+                break;
+            }
+            statements++;
+            start = std::chrono::steady_clock::now();
+            auto operators = statement->builder ? statement->builder->operatorNodes()
+                                                : TreeBuilder::findOperatorNodes(statement->tree);
+            folded += visitor.foldConstants(operators);
+            visitor.findMulAssignModuli(statement->tree);
+            foldMs += millisecondsSince(start);
+            start = std::chrono::steady_clock::now();
+            visitor.visit(statement->tree);
+            runMs += millisecondsSince(start);
+            if (statement->definesFunction) {
+                definitions.push_back(std::move(statement));
+            } else {
+                visitor.forgetNodeCaches(statement->tree, operators);
+                statement.reset();
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        std::string msg = e.what();
+        std::cout << "Traceback (most recent call last):" << std::endl;
+        std::cout << msg << std::endl;
+    }
+    
+    if (timing) {
+        std::cout.flush();
+        std::cerr << "lex+parse: " << parseMs << " ms (" << statements << " statements, streamed)" << std::endl;
+        std::cerr << "fold: " << foldMs << " ms (" << folded << " constant expressions)" << std::endl;
+        std::cerr << "run: " << runMs << " ms" << std::endl;
+    }
+}
+
+// Ends the process once the output is flushed. Destroying the program first
+// would only free memory, and for a large tree that takes as long as parsing
+[[noreturn]] static void finishRun(RunArgs& args) {
+    std::cout.flush();
+    StartupProfile& profile = args.profile;
+    if (profile.enabled) {
+        std::cerr << "before main: " << profile.cpuBeforeMain
+                  << " ms CPU (loading, relocation, static initialization)" << std::endl;
+        for (auto& phase : profile.phases) {
+            std::cerr << phase.first << ": " << phase.second << " ms" << std::endl;
+        }
+        std::cerr << "total from main: " << millisecondsSince(profile.mainStart) << " ms" << std::endl;
+    }
+    std::_Exit(args.result);
+}
+
 static void* run_interpreter(void* arg) {
     RunArgs* args = static_cast<RunArgs*>(arg);
     
-    ANTLRInputStream input(std::cin);
-    Python3Lexer lexer(&input);
-    CommonTokenStream tokens(&lexer);
-    tokens.fill();
-    Python3Parser parser(&tokens);
-    tree::ParseTree *tree = parser.file_input();
+    // --timing: report lex / parse / run times on stderr
+    // --antlr-lexer: tokenize with the generated Python3Lexer instead of Tokenizer
+    // --antlr-parser: parse with the generated Python3Parser instead of TreeBuilder
+    // --dump-tokens, --dump-tree: print the token stream or parse tree and exit
+    //   without running
+    // --stream: run each top-level statement as soon as it is parsed
+    // --startup-profile: report the time each phase of the run took on stderr
+    bool timing = false;
+    bool antlrLexer = false;
+    bool antlrParser = false;
+    bool dumpTokenStream = false;
+    bool dumpParseTree = false;
+    bool stream = false;
+    for (int i = 1; i < args->argc; i++) {
+        if (std::strcmp(args->argv[i], "--timing") == 0) {
+            timing = true;
+        } else if (std::strcmp(args->argv[i], "--antlr-lexer") == 0) {
+            antlrLexer = true;
+        } else if (std::strcmp(args->argv[i], "--antlr-parser") == 0) {
+            antlrParser = true;
+        } else if (std::strcmp(args->argv[i], "--dump-tokens") == 0) {
+            dumpTokenStream = true;
+        } else if (std::strcmp(args->argv[i], "--dump-tree") == 0) {
+            dumpParseTree = true;
+        } else if (std::strcmp(args->argv[i], "--stream") == 0) {
+            stream = true;
+        } else if (std::strcmp(args->argv[i], "--startup-profile") == 0) {
+            args->profile.enabled = true;
+        }
+    }
+    StartupProfile& profile = args->profile;
+    profile.mark("interpreter thread start");
+    
+    auto start = std::chrono::steady_clock::now();
+    SourceStream input(STDIN_FILENO);
+    profile.mark("read input");
+    // Python3Lexer deserializes its ATN when the first one is constructed
+    std::unique_ptr<TokenSource> lexer;
+    if (antlrLexer) {
+        lexer = std::make_unique<Python3Lexer>(&input);
+    } else {
+        lexer = std::make_unique<Tokenizer>(&input);
+    }
+    profile.mark("lexer setup");
+    if (stream && !dumpTokenStream && !dumpParseTree) {
+        runStatements(*lexer, antlrParser, timing);
+        profile.mark("lex, parse and run (streamed)");
+        args->result = 0;
+        finishRun(*args);
+    }
+    // A program cached by an earlier run of the same source (see
+    // ProgramCache) skips lexing and parsing
+    std::unique_ptr<ProgramCache> cache;
+    std::unique_ptr<ProgramCache::Program> program;
+    if (!antlrLexer && !antlrParser && !dumpTokenStream && !dumpParseTree) {
+        cache = ProgramCache::fromEnvironment(input);
+        program = cache ? cache->load() : nullptr;
+    }
+    CommonTokenStream tokens(lexer.get());
+    if (!program) {
+        tokens.fill();
+    }
+    double lexMs = millisecondsSince(start);
+    profile.mark(program ? "load cached program" : "lex");
+    if (dumpTokenStream) {
+        dumpTokens(tokens);
+        args->result = 0;
+        return nullptr;
+    }
+    
+    // TreeBuilder gives up on a syntax error; Python3Parser then reports it
+    // and parses with error recovery as before
+    start = std::chrono::steady_clock::now();
+    std::unique_ptr<TreeBuilder> builder;
+    std::unique_ptr<Python3Parser> parser;
+    tree::ParseTree *tree = nullptr;
+    std::string parseMode = "TreeBuilder";
+    if (program) {
+        tree = program->tree;
+        parseMode = "cached";
+    } else if (!antlrParser) {
+        builder = std::make_unique<TreeBuilder>(tokens);
+        tree = builder->parse();
+    }
+    if (!tree) {
+        parser = std::make_unique<Python3Parser>(&tokens);
+        bool usedFallback = false;
+        tree = parseFileInput(*parser, tokens, usedFallback);
+        parseMode = usedFallback ? "SLL failed, LL" : "SLL";
+    }
+    double parseMs = millisecondsSince(start);
+    profile.mark("parse");
+    if (dumpParseTree) {
+        Python3Parser names(&tokens);
+        dumpTree(tree, names.getRuleNames(), 0);
+        args->result = 0;
+        return nullptr;
+    }
+    
+    // Constant subexpressions are evaluated once here rather than on every run
+    // through them (see EvalVisitor::foldConstants), and `x *= y; x %= m`
+    // pairs are found for fusing; a cached program comes with both
+    start = std::chrono::steady_clock::now();
     EvalVisitor visitor;
+    profile.mark("visitor setup");
+    size_t folded = 0;
+    if (program) {
+        folded = program->analysis.constants.size();
+        visitor.restoreTreeAnalysis(std::move(program->analysis));
+    } else {
+        TreeBuilder* built = parser ? nullptr : builder.get();
+        folded = visitor.foldConstants(built ? built->operatorNodes() : TreeBuilder::findOperatorNodes(tree));
+        visitor.findMulAssignModuli(tree);
+    }
+    double foldMs = millisecondsSince(start);
+    profile.mark("fold");
+    
+    start = std::chrono::steady_clock::now();
     try {
         visitor.visit(tree);
     } catch (const std::runtime_error& e) {
@@ -29,9 +317,33 @@ static void* run_interpreter(void* arg) {
         std::cout << "Traceback (most recent call last):" << std::endl;
         std::cout << msg << std::endl;
     }
+    double runMs = millisecondsSince(start);
+    profile.mark("run");
+    
+    // Saved once the program's output is out
+    double saveMs = 0;
+    if (cache && builder && !parser) {
+        std::cout.flush();
+        start = std::chrono::steady_clock::now();
+        cache->save(tokens.getTokens(), tree, visitor.treeAnalysis());
+        saveMs = millisecondsSince(start);
+        profile.mark("save to cache");
+    }
+    
+    if (timing) {
+        std::cout.flush();
+        size_t tokenCount = program ? program->tokens.size() : tokens.size();
+        std::cerr << "lex: " << lexMs << " ms (" << tokenCount << " tokens)" << std::endl;
+        std::cerr << "parse: " << parseMs << " ms (" << parseMode << ")" << std::endl;
+        std::cerr << "fold: " << foldMs << " ms (" << folded << " constant expressions)" << std::endl;
+        std::cerr << "run: " << runMs << " ms" << std::endl;
+        if (saveMs > 0) {
+            std::cerr << "save: " << saveMs << " ms" << std::endl;
+        }
+    }
     
     args->result = 0;
-    return nullptr;
+    finishRun(*args);
 }
 
 int main(int argc, const char *argv[]) {
@@ -39,6 +351,11 @@ int main(int argc, const char *argv[]) {
     args.argc = argc;
     args.argv = argv;
     args.result = 0;
+    timespec cpu;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+    args.profile.cpuBeforeMain = cpu.tv_sec * 1e3 + cpu.tv_nsec / 1e6;
+    args.profile.mainStart = std::chrono::steady_clock::now();
+    args.profile.last = args.profile.mainStart;
     
     pthread_t thread;
     pthread_attr_t attr;
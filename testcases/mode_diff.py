@@ -0,0 +1,40 @@
+# Runs every test case through ./code in two modes and checks both print the
+# same output. A mode is the flags passed to code, as one argument:
+#   python3 mode_diff.py "--dump-tokens" "--dump-tokens --antlr-lexer"  # Tokenizer vs Python3Lexer
+#   python3 mode_diff.py "--dump-tree" "--dump-tree --antlr-parser"      # TreeBuilder vs Python3Parser
+#   python3 mode_diff.py "" "--stream"                                    # whole program vs one statement at a time
+# Usage: python3 mode_diff.py FLAGS FLAGS [path to code, default ./code]
+import os
+import shlex
+import subprocess
+import sys
+
+if len(sys.argv) < 3:
+    print("usage: python3 mode_diff.py FLAGS FLAGS [path to code]")
+    sys.exit(2)
+modes = [sys.argv[1], sys.argv[2]]
+code = sys.argv[3] if len(sys.argv) > 3 else "./code"
+root = os.path.dirname(os.path.abspath(__file__))
+total = 0
+failed = 0
+for directory, _, files in sorted(os.walk(root)):
+    for name in sorted(files):
+        if not name.endswith(".in"):
+            continue
+        path = os.path.join(directory, name)
+        with open(path, "rb") as f:
+            source = f.read()
+        outputs = [subprocess.run([code] + shlex.split(mode), input=source, capture_output=True).stdout
+                   for mode in modes]
+        total += 1
+        if outputs[0] != outputs[1]:
+            failed += 1
+            ours = outputs[0].decode(errors="replace").splitlines()
+            theirs = outputs[1].decode(errors="replace").splitlines()
+            line = next((i for i in range(min(len(ours), len(theirs))) if ours[i] != theirs[i]),
+                        min(len(ours), len(theirs)))
+            print("output differs:", os.path.relpath(path, root), "at line", line + 1)
+            for mode, lines in zip(modes, (ours, theirs)):
+                print("  " + (mode or "(no flags)") + ":", lines[line] if line < len(lines) else "<end>")
+print(total - failed, "of", total, "test cases run identically")
+sys.exit(1 if failed else 0)
@@ -3,7 +3,7 @@ import os
 if os.path.exists("temp"):
     os.system("rm -rf ./temp")
 os.makedirs("temp")
-for i in range(16):
+for i in range(17):
     inst ="./code < testData/test"+str(i)+".in > temp/test"+str(i)+".out"
     print(inst)
     os.system(inst)
@@ -13,7 +13,7 @@ for i in range(16):
         print("test", i, "wrong:", title)
 os.system("rm -rf ./temp")
 os.makedirs("temp")
-for i in range(20):
+for i in range(24):
     inst = "./code < BigIntegerTest/BigIntegerTest" + str(i) + ".in > temp/test" + str(i) + ".out"
     print(inst)
     os.system(inst)